@@ -0,0 +1,300 @@
+#include "CpuAffinity.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace CpuAffinity {
+
+namespace {
+
+constexpr std::array<const char*, numberOfStages> stageNames{ "decode", "preprocess", "inference", "render" };
+
+// * The stage the calling thread is pinned for, with the layout generation it was pinned with
+struct ThreadStage {
+    uint32_t generation = 0;
+    int stage = -1;
+};
+thread_local ThreadStage currentThreadStage;
+
+std::string Trim( const std::string& text )
+{
+    const size_t first = text.find_first_not_of( " \t" );
+    if ( first == std::string::npos )
+        return { };
+    const size_t last = text.find_last_not_of( " \t" );
+    return text.substr( first, last - first + 1 );
+}
+
+bool ParseIndex( const std::string& text, int& index )
+{
+    const std::string trimmed = Trim( text );
+    const auto isDigit = []( char c ) { return std::isdigit( static_cast<unsigned char>( c ) ) != 0; };
+    if ( trimmed.empty( ) || trimmed.size( ) > 4 || !std::all_of( trimmed.begin( ), trimmed.end( ), isDigit ) )
+        return false;
+    index = std::stoi( trimmed );
+    return index < Partition::maxNumberOfCpus;
+}
+
+} // namespace
+
+bool ParseCpuSet( const std::string& text, CpuSet& cpus )
+{
+    cpus.clear( );
+    if ( Trim( text ).empty( ) )
+        return true;
+
+    std::stringstream stream( text );
+    std::string range;
+    while ( std::getline( stream, range, ',' ) ) {
+        const size_t dash = range.find( '-' );
+        int first = 0;
+        int last = 0;
+        if ( dash == std::string::npos ) {
+            if ( !ParseIndex( range, first ) )
+                return false;
+            last = first;
+        }
+        else if ( !ParseIndex( range.substr( 0, dash ), first ) || !ParseIndex( range.substr( dash + 1 ), last )
+                  || last < first ) {
+            return false;
+        }
+        for ( int cpu = first; cpu <= last; ++cpu )
+            cpus.push_back( cpu );
+    }
+    std::sort( cpus.begin( ), cpus.end( ) );
+    cpus.erase( std::unique( cpus.begin( ), cpus.end( ) ), cpus.end( ) );
+    return true;
+}
+
+std::string ToString( const CpuSet& cpus )
+{
+    std::string text;
+    for ( size_t i = 0; i < cpus.size( ); ) {
+        size_t j = i;
+        while ( j + 1 < cpus.size( ) && cpus[ j + 1 ] == cpus[ j ] + 1 )
+            ++j;
+        if ( !text.empty( ) )
+            text += ',';
+        text += j == i ? std::to_string( cpus[ i ] ) : std::format( "{}-{}", cpus[ i ], cpus[ j ] );
+        i = j + 1;
+    }
+    return text;
+}
+
+bool PinCurrentThread( const CpuSet& cpus )
+{
+    if ( cpus.empty( ) )
+        return true;
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for ( const int cpu : cpus ) {
+        if ( cpu < static_cast<int>( sizeof( DWORD_PTR ) * 8 ) )
+            mask |= DWORD_PTR{ 1 } << cpu;
+    }
+    return mask != 0 && SetThreadAffinityMask( GetCurrentThread( ), mask ) != 0;
+#elif defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for ( const int cpu : cpus )
+        CPU_SET( cpu, &set );
+    return pthread_setaffinity_np( pthread_self( ), sizeof( set ), &set ) == 0;
+#else
+    return false;
+#endif
+}
+
+bool GetCurrentThreadAffinity( CpuSet& cpus )
+{
+    cpus.clear( );
+#ifdef _WIN32
+    // * There is no getter for the thread mask, it is swapped with the process mask and put back
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if ( !GetProcessAffinityMask( GetCurrentProcess( ), &processMask, &systemMask ) )
+        return false;
+    const DWORD_PTR threadMask = SetThreadAffinityMask( GetCurrentThread( ), processMask );
+    if ( threadMask == 0 )
+        return false;
+    SetThreadAffinityMask( GetCurrentThread( ), threadMask );
+    for ( int cpu = 0; cpu < static_cast<int>( sizeof( DWORD_PTR ) * 8 ); ++cpu ) {
+        if ( threadMask & ( DWORD_PTR{ 1 } << cpu ) )
+            cpus.push_back( cpu );
+    }
+    return true;
+#elif defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    if ( pthread_getaffinity_np( pthread_self( ), sizeof( set ), &set ) != 0 )
+        return false;
+    for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+        if ( CPU_ISSET( cpu, &set ) )
+            cpus.push_back( cpu );
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int CurrentCpu( )
+{
+#ifdef _WIN32
+    return static_cast<int>( GetCurrentProcessorNumber( ) );
+#elif defined( __linux__ )
+    return sched_getcpu( );
+#else
+    return -1;
+#endif
+}
+
+const char* StageName( Stage stage )
+{
+    return stageNames[ static_cast<size_t>( stage ) ];
+}
+
+// ##################################
+
+bool Layout::IsPinned( ) const
+{
+    return std::any_of( cpus.begin( ), cpus.end( ), []( const CpuSet& set ) { return !set.empty( ); } );
+}
+
+bool Layout::Parse( const std::string& text, Layout& layout )
+{
+    layout = { };
+    layout.name = text.empty( ) ? "unpinned" : text;
+
+    std::stringstream stream( text );
+    std::string assignment;
+    while ( std::getline( stream, assignment, ';' ) ) {
+        if ( Trim( assignment ).empty( ) )
+            continue;
+        const size_t equals = assignment.find( '=' );
+        if ( equals == std::string::npos )
+            return false;
+        const std::string stage = Trim( assignment.substr( 0, equals ) );
+        const auto it = std::find_if( stageNames.begin( ), stageNames.end( ), [ & ]( const char* name ) {
+            return stage == name;
+        } );
+        if ( it == stageNames.end( ) )
+            return false;
+        if ( !ParseCpuSet( assignment.substr( equals + 1 ), layout.cpus[ it - stageNames.begin( ) ] ) )
+            return false;
+    }
+    return true;
+}
+
+// ##################################
+
+Partition& Partition::Global( )
+{
+    static Partition partition;
+    return partition;
+}
+
+void Partition::Configure( const Layout& layout, std::unique_ptr<Logger::ILogger> logger )
+{
+    mLayout = layout;
+    mLogger = std::move( logger );
+    if ( !GetCurrentThreadAffinity( mUnpinnedCpus ) )
+        mUnpinnedCpus.clear( );
+    mGeneration.fetch_add( 1, std::memory_order_relaxed );
+    ResetObserved( );
+}
+
+void Partition::Enter( Stage stage )
+{
+    const uint32_t generation = mGeneration.load( std::memory_order_relaxed );
+    if ( currentThreadStage.generation != generation || currentThreadStage.stage != static_cast<int>( stage ) ) {
+        const CpuSet& cpus = mLayout[ stage ];
+        const CpuSet& target = cpus.empty( ) && mLayout.IsPinned( ) ? mUnpinnedCpus : cpus;
+        if ( !PinCurrentThread( target ) && mLogger ) {
+            mLogger->Log(
+                Logger::Priority::Warning,
+                std::format(
+                    "Could not pin a {} thread to cpus {}, it keeps its current affinity",
+                    StageName( stage ),
+                    ToString( target )
+                )
+            );
+        }
+        currentThreadStage = { .generation = generation, .stage = static_cast<int>( stage ) };
+    }
+    Record( stage );
+}
+
+void Partition::Record( Stage stage )
+{
+    const int cpu = CurrentCpu( );
+    if ( cpu < 0 || cpu >= maxNumberOfCpus )
+        return;
+    mObserved[ static_cast<size_t>( stage ) ][ cpu / 64 ].fetch_or(
+        uint64_t{ 1 } << ( cpu % 64 ), std::memory_order_relaxed
+    );
+}
+
+CpuSet Partition::ObservedCpus( Stage stage ) const
+{
+    CpuSet cpus;
+    const auto& words = mObserved[ static_cast<size_t>( stage ) ];
+    for ( size_t w = 0; w < words.size( ); ++w ) {
+        const uint64_t word = words[ w ].load( std::memory_order_relaxed );
+        for ( int bit = 0; bit < 64; ++bit ) {
+            if ( word & ( uint64_t{ 1 } << bit ) )
+                cpus.push_back( static_cast<int>( w * 64 ) + bit );
+        }
+    }
+    return cpus;
+}
+
+void Partition::ResetObserved( )
+{
+    for ( auto& words : mObserved ) {
+        for ( auto& word : words )
+            word.store( 0, std::memory_order_relaxed );
+    }
+}
+
+std::string Partition::Report( ) const
+{
+    std::string report = std::format( "cpu layout '{}'", mLayout.name );
+    for ( size_t s = 0; s < numberOfStages; ++s ) {
+        const Stage stage = static_cast<Stage>( s );
+        const CpuSet& configured = mLayout[ stage ];
+        const CpuSet observed = ObservedCpus( stage );
+        report += std::format(
+            "\n  {:<10} pinned {:<12} ran on {}",
+            StageName( stage ),
+            configured.empty( ) ? "-" : ToString( configured ),
+            observed.empty( ) ? "-" : ToString( observed )
+        );
+    }
+    return report;
+}
+
+// ##################################
+
+ScopedStage::ScopedStage( Stage stage ) : mRestore( false )
+{
+    mRestore = Partition::Global( ).GetLayout( ).IsPinned( ) && GetCurrentThreadAffinity( mPreviousCpus );
+    Partition::Global( ).Enter( stage );
+}
+
+ScopedStage::~ScopedStage( )
+{
+    if ( mRestore )
+        PinCurrentThread( mPreviousCpus );
+    currentThreadStage = { };
+}
+
+} // namespace CpuAffinity
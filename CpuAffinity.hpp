@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Logger.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// * Core partitioning of the pipeline stages. A Layout assigns a set of logical CPUs to every stage, threads pin
+// * themselves when they enter a stage and record the CPU they run on, so that the placement actually achieved can
+// * be reported next to the configured one. Stages with an empty set are left to the OS scheduler.
+namespace CpuAffinity {
+
+// * Sorted, unique logical CPU indices
+using CpuSet = std::vector<int>;
+
+// * Linux style list, e.g. "0-3,8,10-11". An empty string is an empty set, returns false on malformed input.
+bool ParseCpuSet( const std::string& text, CpuSet& cpus );
+
+std::string ToString( const CpuSet& cpus );
+
+// * Pins the calling thread to 'cpus', an empty set is a no-op. Linux uses pthread_setaffinity_np, Windows
+// * SetThreadAffinityMask (first 64 CPUs of the current processor group), other platforms return false.
+bool PinCurrentThread( const CpuSet& cpus );
+
+bool GetCurrentThreadAffinity( CpuSet& cpus );
+
+// * -1 if unknown
+int CurrentCpu( );
+
+enum class Stage {
+    Decode,     // * Frame acquisition and image decoding
+    Preprocess, // * Frame processing function, also the thread calling into the inference engine
+    Inference,  // * onnxruntime intra-op pool
+    Render      // * Drawing and display loop
+};
+constexpr size_t numberOfStages = 4;
+
+const char* StageName( Stage stage );
+
+struct Layout {
+    std::string name = "unpinned";
+    std::array<CpuSet, numberOfStages> cpus;
+
+    const CpuSet& operator[]( Stage stage ) const { return cpus[ static_cast<size_t>( stage ) ]; }
+
+    bool IsPinned( ) const;
+
+    // * "decode=0-1;preprocess=2;inference=4-7;render=3", stages left out are unpinned. The name defaults to 'text'.
+    static bool Parse( const std::string& text, Layout& layout );
+};
+
+// * Process wide partition. Configure it before the pipeline threads and the inference session are created, threads
+// * pick up the layout when they first enter a stage. New threads inherit the affinity of their creator, so with a
+// * pinned layout threads entering an unpinned stage are reset to the affinity the configuring thread had.
+class Partition {
+public:
+    static constexpr int maxNumberOfCpus = 256;
+
+    static Partition& Global( );
+
+    // * 'logger' reports pinning failures, it is called from every thread entering a stage
+    void Configure( const Layout& layout, std::unique_ptr<Logger::ILogger> logger );
+
+    const Layout& GetLayout( ) const { return mLayout; }
+
+    // * Pins the calling thread to the stage CPUs, once per thread and layout, and records the current CPU. A failure
+    // * to pin is logged as a warning, the thread then keeps running where it is.
+    void Enter( Stage stage );
+
+    // * Records the current CPU only, cheap enough for every frame
+    void Record( Stage stage );
+
+    CpuSet ObservedCpus( Stage stage ) const;
+
+    void ResetObserved( );
+
+    // * One line per stage, configured vs observed CPUs
+    std::string Report( ) const;
+
+private:
+    static constexpr size_t numberOfWords = maxNumberOfCpus / 64;
+
+    Layout mLayout;
+    std::unique_ptr<Logger::ILogger> mLogger;
+    CpuSet mUnpinnedCpus;
+    std::atomic<uint32_t> mGeneration = 1;
+    std::array<std::array<std::atomic<uint64_t>, numberOfWords>, numberOfStages> mObserved{ };
+};
+
+// * Enters 'stage' for the lifetime of the scope and restores the previous affinity of the thread afterwards
+class ScopedStage {
+public:
+    explicit ScopedStage( Stage stage );
+
+    ~ScopedStage( );
+
+    ScopedStage( const ScopedStage& ) = delete;
+    ScopedStage& operator=( const ScopedStage& ) = delete;
+
+private:
+    CpuSet mPreviousCpus;
+    bool mRestore;
+};
+
+} // namespace CpuAffinity
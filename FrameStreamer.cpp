@@ -1,111 +1,196 @@
 #include "FrameStreamer.hpp"
+#include "CpuAffinity.hpp"
+#include "MappedFile.hpp"
+#include "Metrics.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
-#include <future>
-#include <iostream>
+#include <fstream>
+#include <stdexcept>
 
 #include <opencv2/highgui.hpp>
+#include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
 namespace {
 
-void ProcessFrame(
-    cv::Mat& frame, FrameStreamer::FrameProcessFunction f, std::future<FrameStreamer::Result>& processResult
-)
+bool IsImageFile( const std::filesystem::path& path )
 {
-    if ( f && !processResult.valid( ) ) {
-        processResult = std::async(
-            std::launch::async, f, frame
-        ); // TODO: Need to ensure that frame is not overwritten before processed
+    std::string extension = path.extension( ).string( );
+    std::transform( extension.begin( ), extension.end( ), extension.begin( ), []( unsigned char c ) {
+        return static_cast<char>( std::tolower( c ) );
+    } );
+    for ( const char* imageExtension : { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp" } ) {
+        if ( extension == imageExtension )
+            return true;
     }
+    return false;
 }
 
-bool GetProcessedFrameResult(
-    FrameStreamer::Result& result,
-    FrameStreamer::FrameProcessFunction f,
-    std::future<FrameStreamer::Result>& processResult
-)
+// * Supports '*' and '?'
+bool MatchesWildcard( const std::string& text, const std::string& pattern )
 {
-    using namespace std::chrono_literals;
-    if ( f ) {
-        if ( processResult.valid( ) && processResult.wait_for( 0ms ) == std::future_status::ready ) {
-            result = processResult.get( );
-            return true;
+    size_t t = 0;
+    size_t p = 0;
+    size_t starPattern = std::string::npos;
+    size_t starText = 0;
+    while ( t < text.size( ) ) {
+        if ( p < pattern.size( ) && ( pattern[ p ] == '?' || pattern[ p ] == text[ t ] ) ) {
+            ++t;
+            ++p;
+        }
+        else if ( p < pattern.size( ) && pattern[ p ] == '*' ) {
+            starPattern = p++;
+            starText = t;
+        }
+        else if ( starPattern != std::string::npos ) {
+            p = starPattern + 1;
+            t = ++starText;
+        }
+        else {
+            return false;
         }
     }
-    return false;
+    while ( p < pattern.size( ) && pattern[ p ] == '*' )
+        ++p;
+    return p == pattern.size( );
 }
 
-} // namespace
-
-void FrameStreamer::Run( FrameProcessFunction f )
+std::vector<std::filesystem::path> ResolveImageSequence( const std::string& source )
 {
-    enum class State {
-        Running,
-        Paused
-    };
+    namespace fs = std::filesystem;
+    std::vector<fs::path> paths;
+    const fs::path sourcePath( source );
 
-    using namespace std::chrono_literals;
-    using enum State;
+    if ( fs::is_directory( sourcePath ) ) {
+        for ( const auto& entry : fs::directory_iterator( sourcePath ) ) {
+            if ( entry.is_regular_file( ) && IsImageFile( entry.path( ) ) )
+                paths.push_back( entry.path( ) );
+        }
+        std::sort( paths.begin( ), paths.end( ) );
+    }
+    else if ( source.find_first_of( "*?" ) != std::string::npos ) {
+        const fs::path directory = sourcePath.has_parent_path( ) ? sourcePath.parent_path( ) : fs::path( "." );
+        const std::string pattern = sourcePath.filename( ).string( );
+        if ( fs::is_directory( directory ) ) {
+            for ( const auto& entry : fs::directory_iterator( directory ) ) {
+                if ( entry.is_regular_file( ) && MatchesWildcard( entry.path( ).filename( ).string( ), pattern ) )
+                    paths.push_back( entry.path( ) );
+            }
+        }
+        std::sort( paths.begin( ), paths.end( ) );
+    }
+    else if ( fs::is_regular_file( sourcePath ) && IsImageFile( sourcePath ) ) {
+        paths.push_back( sourcePath );
+    }
+    else if ( fs::is_regular_file( sourcePath ) ) {
+        // * Manifest, order is kept as listed. Manifests may list anything, so entries are checked here to fail early
+        // * rather than on every pass over the sequence, listed directories only contain existing files.
+        std::ifstream manifest( sourcePath );
+        std::string line;
+        while ( std::getline( manifest, line ) ) {
+            while ( !line.empty( ) && std::isspace( static_cast<unsigned char>( line.back( ) ) ) )
+                line.pop_back( );
+            if ( line.empty( ) || line.front( ) == '#' )
+                continue;
+            const fs::path imagePath( line );
+            paths.push_back( imagePath.is_absolute( ) ? imagePath : sourcePath.parent_path( ) / imagePath );
+            if ( !fs::is_regular_file( paths.back( ) ) )
+                throw std::runtime_error( "entry " + paths.back( ).string( ) + " does not exist" );
+        }
+    }
+    return paths;
+}
 
-    cv::Mat frame;
-    cv::Mat poseFrame;
+cv::Mat DecodeImage( const std::filesystem::path& imagePath )
+{
+    const MappedFile file( imagePath );
+    if ( !file.IsOpen( ) || file.Size( ) == 0 )
+        return { };
 
-    int count = 0;
-    int keyPressed = 0;
+    const cv::Mat encoded( 1, static_cast<int>( file.Size( ) ), CV_8U, const_cast<unsigned char*>( file.Data( ) ) );
+    try {
+        return cv::imdecode( encoded, cv::IMREAD_COLOR );
+    }
+    catch ( const std::exception& ) {
+        return { };
+    }
+}
 
-    std::future<Result> processResult;
-    Result mostRecentResult;
+} // namespace
 
-    State s = Running;
-    const long long waitTime = 1 / ( mFps / 1000000.0 );
-    const auto runStart = std::chrono::high_resolution_clock::now( );
+void FrameStreamer::Run( )
+{
+    const CpuAffinity::ScopedStage renderStage( CpuAffinity::Stage::Render );
 
-    while ( !( keyPressed == 'q' || keyPressed == 'Q' ) ) {
-        auto nextTick = runStart + ( ++count * std::chrono::microseconds( waitTime ) );
-        switch ( s ) {
-        case Running:
-            if ( keyPressed == 'p' || keyPressed == 'P' ) {
-                s = Paused;
-                break;
-            }
-            if ( !AcquireNextFrame( frame ) )
-                return;
-            ProcessFrame( frame, f, processResult );
-            break;
-        case Paused:
-            if ( keyPressed == 'r' || keyPressed == 'R' ) {
-                s = Running;
-            }
-            else if ( keyPressed == 'f' || keyPressed == 'F' ) {
-                if ( !AcquireNextFrame( frame ) )
-                    return;
-                ProcessFrame( frame, f, processResult );
-            }
-            else if ( keyPressed == 'b' || keyPressed == 'B' ) {
-                if ( !AcquirePreviousFrame( frame ) )
-                    return;
-                ProcessFrame( frame, f, processResult );
-            }
-            break;
-        }
+    cv::Mat frame;
+    const cv::Mat noOverlay;
+    State state = State::Running;
+    int keyPressed = 0;
+    int count = 0;
+    const auto framePeriod = FramePeriod( );
+    const auto runStart = std::chrono::high_resolution_clock::now( );
 
+    while ( !IsQuitKey( keyPressed ) ) {
+        const auto nextTick = runStart + ( ++count * framePeriod );
+        bool acquired = false;
+        if ( !Advance( keyPressed, state, frame, acquired ) )
+            return;
         std::this_thread::sleep_until( nextTick );
+        keyPressed = Display( frame, noOverlay );
+    }
+}
 
-        if ( GetProcessedFrameResult( mostRecentResult, f, processResult ) ) {
-            poseFrame = DrawUtils::DrawPosesInFrame(
-                frame.size( ), frame.type( ), mostRecentResult.modelOutput, mostRecentResult.scaleFactor
-            );
+bool FrameStreamer::Advance( int keyPressed, State& state, cv::Mat& frame, bool& acquired )
+{
+    acquired = false;
+    switch ( state ) {
+    case State::Running:
+        if ( keyPressed == 'p' || keyPressed == 'P' ) {
+            state = State::Paused;
+            break;
         }
-
-        if ( !poseFrame.empty( ) ) {
-            cv::imshow( mWindowName, frame + poseFrame );
+        if ( !AcquireNextFrame( frame ) )
+            return false;
+        acquired = true;
+        break;
+    case State::Paused:
+        if ( keyPressed == 'r' || keyPressed == 'R' ) {
+            state = State::Running;
         }
-        else {
-            cv::imshow( mWindowName, frame );
+        else if ( keyPressed == 'f' || keyPressed == 'F' ) {
+            if ( !AcquireNextFrame( frame ) )
+                return false;
+            acquired = true;
         }
-        keyPressed = cv::waitKey( 1 );
+        else if ( keyPressed == 'b' || keyPressed == 'B' ) {
+            if ( !AcquirePreviousFrame( frame ) )
+                return false;
+            acquired = true;
+        }
+        break;
+    }
+    return true;
+}
+
+int FrameStreamer::Display( const cv::Mat& frame, const cv::Mat& overlay )
+{
+    if ( !overlay.empty( ) && overlay.size( ) == frame.size( ) && overlay.type( ) == frame.type( ) ) {
+        cv::add( frame, overlay, mDisplayFrame );
+        cv::imshow( mWindowName, mDisplayFrame );
+    }
+    else {
+        cv::imshow( mWindowName, frame );
     }
+    Metrics::PipelineMetrics::Get( ).displayFrames.Increment( );
+    CpuAffinity::Partition::Global( ).Record( CpuAffinity::Stage::Render );
+    return cv::waitKey( 1 );
+}
+
+std::chrono::microseconds FrameStreamer::FramePeriod( ) const
+{
+    return std::chrono::microseconds( static_cast<long long>( 1 / ( mFps / 1000000.0 ) ) );
 }
 
 // ##################################
@@ -114,7 +199,7 @@ bool ImageStreamer::Initialize( )
 {
     try {
         mImage = cv::imread( mImageFilePath );
-        mIsInitialized = true;
+        mIsInitialized = !mImage.empty( );
         mFps = 30.f;
         mNumberOfFrames = 1;
     }
@@ -140,19 +225,114 @@ bool ImageStreamer::AcquirePreviousFrame( cv::Mat& frame )
 
 // ##################################
 
-bool VideoStreamer::Initialize( )
+bool ImageSequenceStreamer::Initialize( )
 {
     try {
-        mCap = cv::VideoCapture( mVideoFilePath );
-        mIsInitialized = mCap.isOpened( );
-        if ( mIsInitialized ) {
+        mImagePaths = ResolveImageSequence( mSource );
+    }
+    catch ( const std::exception& exception ) {
+        mLogger->Log(
+            Logger::Priority::Error, "Failed to resolve image sequence " + mSource + ": " + exception.what( )
+        );
+        mImagePaths.clear( );
+    }
+
+    mIsInitialized = !mImagePaths.empty( );
+    if ( mIsInitialized ) {
+        mFps = 30.f;
+        mNumberOfFrames = static_cast<int>( mImagePaths.size( ) );
+        mDecoders = std::make_unique<ThreadPool>( mNumberOfThreads, []( ) {
+            CpuAffinity::Partition::Global( ).Enter( CpuAffinity::Stage::Decode );
+        } );
+        if ( mPrefetchDepth == 0 )
+            mPrefetchDepth = 2 * mDecoders->Size( );
+        RestartAt( 0 );
+    }
+    return mIsInitialized;
+}
+
+bool ImageSequenceStreamer::AcquireNextFrame( cv::Mat& frame )
+{
+    if ( !mIsInitialized )
+        return false;
+
+    // * Undecodable images are skipped, the stream only ends if none of the images can be decoded
+    for ( size_t attempt = 0; attempt < mImagePaths.size( ); ++attempt ) {
+        const size_t index = mNextIndex;
+        frame = mPrefetched.front( ).get( );
+        mPrefetched.pop_front( );
+        mNextIndex = ( mNextIndex + 1 ) % mImagePaths.size( );
+        Prefetch( );
+        if ( !frame.empty( ) )
+            return true;
+        mLogger->Log( Logger::Priority::Warning, "Skipping undecodable image " + mImagePaths[ index ].string( ) );
+    }
+    return false;
+}
+
+bool ImageSequenceStreamer::AcquirePreviousFrame( cv::Mat& frame )
+{
+    if ( !mIsInitialized )
+        return false;
+
+    // * Same semantics as VideoStreamer, step back to the frame before the one last acquired
+    const size_t n = mImagePaths.size( );
+    const size_t previousIndex = ( mNextIndex + 2 * n - 2 ) % n;
+    RestartAt( previousIndex );
+    return AcquireNextFrame( frame );
+}
+
+void ImageSequenceStreamer::Prefetch( )
+{
+    while ( mPrefetched.size( ) < mPrefetchDepth ) {
+        const std::filesystem::path& imagePath = mImagePaths[ mNextPrefetchIndex ];
+        const uint64_t generation = mGeneration.load( std::memory_order_relaxed );
+        mPrefetched.push_back( mDecoders->Submit( [ this, imagePath, generation ]( ) {
+            // * Cancelled by RestartAt, nobody waits for this frame anymore
+            if ( mGeneration.load( std::memory_order_relaxed ) != generation )
+                return cv::Mat( );
+            CpuAffinity::Partition::Global( ).Record( CpuAffinity::Stage::Decode );
+            return DecodeImage( imagePath );
+        } ) );
+        mNextPrefetchIndex = ( mNextPrefetchIndex + 1 ) % mImagePaths.size( );
+    }
+}
+
+void ImageSequenceStreamer::RestartAt( size_t index )
+{
+    // * Queued decodes of the previous position are skipped, frames already being decoded are completed and discarded
+    mGeneration.fetch_add( 1, std::memory_order_relaxed );
+    mPrefetched.clear( );
+    mNextIndex = index;
+    mNextPrefetchIndex = index;
+    Prefetch( );
+}
+
+// ##################################
+
+bool VideoStreamer::Initialize( )
+{
+    mDecoder = std::make_unique<ThreadPool>( 1, []( ) {
+        CpuAffinity::Partition::Global( ).Enter( CpuAffinity::Stage::Decode );
+    } );
+
+    // * Opened on the decoder thread, threads created by the capture backend then inherit the decode CPUs
+    mIsInitialized = mDecoder->Submit( [ this ]( ) {
+        try {
+            mCap = cv::VideoCapture( mVideoFilePath );
+            if ( !mCap.isOpened( ) )
+                return false;
             mFps = mCap.get( cv::CAP_PROP_FPS );
             mNumberOfFrames = mCap.get( cv::CAP_PROP_FRAME_COUNT );
+            return true;
         }
-    }
-    catch ( const std::exception& ) {
-        mIsInitialized = false;
-    }
+        catch ( const std::exception& ) {
+            return false;
+        }
+    } ).get( );
+
+    if ( mIsInitialized )
+        mNext = mDecoder->Submit( [ this ]( ) { return ReadFrame( ); } );
     return mIsInitialized;
 }
 
@@ -161,13 +341,10 @@ bool VideoStreamer::AcquireNextFrame( cv::Mat& frame )
     if ( !mIsInitialized )
         return false;
 
-    if ( mLoopVideo ) {
-        const int currentFrame = mCap.get( cv::CAP_PROP_POS_FRAMES );
-        if ( currentFrame >= mNumberOfFrames ) {
-            mCap.set( cv::CAP_PROP_POS_FRAMES, 0 );
-        }
-    }
-    mCap >> frame;
+    DecodedFrame decoded = mNext.get( );
+    mNext = mDecoder->Submit( [ this ]( ) { return ReadFrame( ); } );
+    frame = std::move( decoded.frame );
+    mLastIndex = decoded.index;
     return !frame.empty( );
 }
 
@@ -176,13 +353,25 @@ bool VideoStreamer::AcquirePreviousFrame( cv::Mat& frame )
     if ( !mIsInitialized )
         return false;
 
-    const int currentFrame = mCap.get( cv::CAP_PROP_POS_FRAMES );
-    if ( currentFrame != 0 ) {
-        mCap.set( cv::CAP_PROP_POS_FRAMES, currentFrame - 2 );
-    }
-    else {
-        mCap.set( cv::CAP_PROP_POS_FRAMES, mNumberOfFrames );
+    // * Step back to the frame before the one last acquired. The decoder runs one task at a time in order, the frame
+    // * read ahead is discarded.
+    const int previousIndex = mLastIndex > 0 ? mLastIndex - 1 : mNumberOfFrames - 1;
+    mNext = mDecoder->Submit( [ this, previousIndex ]( ) {
+        mCap.set( cv::CAP_PROP_POS_FRAMES, previousIndex );
+        return ReadFrame( );
+    } );
+    return AcquireNextFrame( frame );
+}
+
+VideoStreamer::DecodedFrame VideoStreamer::ReadFrame( )
+{
+    DecodedFrame decoded;
+    decoded.index = static_cast<int>( mCap.get( cv::CAP_PROP_POS_FRAMES ) );
+    if ( mLoopVideo && decoded.index >= mNumberOfFrames ) {
+        mCap.set( cv::CAP_PROP_POS_FRAMES, 0 );
+        decoded.index = 0;
     }
-    mCap >> frame;
-    return !frame.empty( );
+    CpuAffinity::Partition::Global( ).Record( CpuAffinity::Stage::Decode );
+    mCap >> decoded.frame;
+    return decoded;
 }
\ No newline at end of file
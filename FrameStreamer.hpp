@@ -1,10 +1,23 @@
 #pragma once
 
-#include "DrawUtils.hpp"
-#include "PoseEstimator.hpp"
+#include "CpuAffinity.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "ThreadPool.hpp"
 
-#include <functional>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
@@ -13,18 +26,20 @@
 
 class FrameStreamer;
 class ImageStreamer;
+class ImageSequenceStreamer;
 class VideoStreamer;
 
 template <typename T, typename... Ts>
 concept IsAnyOf = ( std::same_as<T, Ts> || ... );
 
 template <typename T>
-concept Streamer = IsAnyOf<T, ImageStreamer, VideoStreamer>;
+concept Streamer = IsAnyOf<T, ImageStreamer, ImageSequenceStreamer, VideoStreamer>;
 
-template <Streamer T>
-std::unique_ptr<FrameStreamer> CreateFrameStreamer( const std::string fileName )
+// * 'arguments' follow the file name in the constructor of T, e.g. the logger of ImageSequenceStreamer
+template <Streamer T, typename... Arguments>
+std::unique_ptr<FrameStreamer> CreateFrameStreamer( const std::string fileName, Arguments&&... arguments )
 {
-    auto streamer = std::make_unique<T>( fileName );
+    auto streamer = std::make_unique<T>( fileName, std::forward<Arguments>( arguments )... );
 
     if ( streamer->Initialize( ) )
         return streamer;
@@ -32,6 +47,143 @@ std::unique_ptr<FrameStreamer> CreateFrameStreamer( const std::string fileName )
         return nullptr;
 }
 
+// ##############################
+
+// * Output of a frame processor, only ever moved. Overlay renders it on a black frame of the given size and type,
+// * which is added to the displayed frame.
+template <typename R>
+concept FrameResult = std::default_initializable<R> && std::movable<R>
+                   && requires( const R& result, const cv::Size& size, int type ) {
+                          { result.Overlay( size, type ) } -> std::same_as<cv::Mat>;
+                      };
+
+// * Processes a frame into a recycled result, 'result' holds an earlier result whose storage should be reused
+template <typename P>
+concept FrameProcessor = FrameResult<typename P::Result>
+                      && requires( P& processor, const cv::Mat& frame, typename P::Result& result ) {
+                             { processor( frame, result ) } -> std::same_as<void>;
+                         };
+
+// * Free list of results, so that steady state processing reuses the storage of earlier results
+template <FrameResult R>
+class ResultPool {
+public:
+    R Acquire( )
+    {
+        if ( mFree.empty( ) )
+            return R{ };
+        R result = std::move( mFree.back( ) );
+        mFree.pop_back( );
+        return result;
+    }
+
+    void Release( R&& result ) { mFree.push_back( std::move( result ) ); }
+
+    size_t Size( ) const { return mFree.size( ); }
+
+private:
+    std::vector<R> mFree;
+};
+
+// * Runs a processor on a dedicated thread, one frame at a time. Frames submitted while the previous one is still
+// * being processed are dropped.
+template <FrameProcessor P>
+class AsyncFrameProcessor {
+public:
+    using Result = typename P::Result;
+
+    explicit AsyncFrameProcessor( P& processor ) :
+        mProcessor( processor ),
+        mState( State::Idle ),
+        mStopping( false ),
+        mThread( &AsyncFrameProcessor::Work, this )
+    {
+    }
+
+    ~AsyncFrameProcessor( )
+    {
+        {
+            std::scoped_lock lock( mMutex );
+            mStopping = true;
+        }
+        mWakeUp.notify_all( );
+        mThread.join( );
+        if ( mState != State::Idle )
+            Metrics::PipelineMetrics::Get( ).queueDepth.Add( -1 );
+    }
+
+    AsyncFrameProcessor( const AsyncFrameProcessor& ) = delete;
+    AsyncFrameProcessor& operator=( const AsyncFrameProcessor& ) = delete;
+
+    // * 'frame' is copied into a buffer owned by the processor thread, returns false if the frame was dropped
+    bool Submit( const cv::Mat& frame )
+    {
+        auto& metrics = Metrics::PipelineMetrics::Get( );
+        {
+            std::scoped_lock lock( mMutex );
+            if ( mState != State::Idle ) {
+                metrics.droppedFrames.Increment( );
+                return false;
+            }
+            frame.copyTo( mFrame );
+            mResult = mFreeResults.Acquire( );
+            mState = State::Pending;
+        }
+        metrics.queueDepth.Add( 1 );
+        mWakeUp.notify_one( );
+        return true;
+    }
+
+    // * Moves a finished result into 'result', whose previous content goes back to the free list
+    bool TryCollect( Result& result )
+    {
+        {
+            std::scoped_lock lock( mMutex );
+            if ( mState != State::Done )
+                return false;
+            mFreeResults.Release( std::exchange( result, std::move( mResult ) ) );
+            mState = State::Idle;
+        }
+        auto& metrics = Metrics::PipelineMetrics::Get( );
+        metrics.queueDepth.Add( -1 );
+        metrics.inferenceFrames.Increment( );
+        return true;
+    }
+
+private:
+    enum class State {
+        Idle,
+        Pending,
+        Done
+    };
+
+    void Work( )
+    {
+        CpuAffinity::Partition::Global( ).Enter( CpuAffinity::Stage::Preprocess );
+        std::unique_lock lock( mMutex );
+        while ( true ) {
+            mWakeUp.wait( lock, [ this ] { return mStopping || mState == State::Pending; } );
+            if ( mStopping )
+                return;
+            // * The submitting thread does not touch mFrame and mResult while a frame is pending
+            lock.unlock( );
+            mProcessor( mFrame, mResult );
+            lock.lock( );
+            mState = State::Done;
+        }
+    }
+
+    P& mProcessor;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    State mState;
+    bool mStopping;
+    cv::Mat mFrame;
+    Result mResult;
+    ResultPool<Result> mFreeResults;
+    std::thread mThread; // * Last, so that it starts once the members it uses are constructed
+};
+
 // ##################################
 
 class FrameStreamer {
@@ -42,27 +194,73 @@ public:
 
     virtual bool Initialize( ) = 0;
 
-    // TODO: Make the result type more generic and not pose estimation dependant
-    struct Result {
-        std::vector<PoseEstimator::Detection> modelOutput;
-        DrawUtils::ScaleFactor scaleFactor;
-    };
+    // * Displays the stream with the most recent result of 'processor' overlaid, see AsyncFrameProcessor
+    template <FrameProcessor P>
+    void Run( P& processor );
 
-    using FrameProcessFunction = std::function<Result( const cv::Mat& inputFrame )>;
-    void Run( FrameProcessFunction f = nullptr );
+    void Run( );
 
 protected:
     float mFps;
     int mNumberOfFrames;
 
 private:
+    enum class State {
+        Running,
+        Paused
+    };
+
+    // * Applies the playback keys and acquires the next frame if needed, false at the end of the stream
+    bool Advance( int keyPressed, State& state, cv::Mat& frame, bool& acquired );
+
+    // * Shows 'frame' plus 'overlay' if not empty, returns the key pressed
+    int Display( const cv::Mat& frame, const cv::Mat& overlay );
+
+    std::chrono::microseconds FramePeriod( ) const;
+
+    static bool IsQuitKey( int keyPressed ) { return keyPressed == 'q' || keyPressed == 'Q'; }
+
     virtual bool AcquireNextFrame( cv::Mat& frame ) = 0;
 
     virtual bool AcquirePreviousFrame( cv::Mat& frame ) = 0;
 
+    cv::Mat mDisplayFrame;
+
     static constexpr std::string mWindowName = "Stream";
 };
 
+template <FrameProcessor P>
+void FrameStreamer::Run( P& processor )
+{
+    // * The display loop acquires the frames, the streamers decode them on threads of their own in the decode stage
+    const CpuAffinity::ScopedStage renderStage( CpuAffinity::Stage::Render );
+    AsyncFrameProcessor<P> asyncProcessor( processor );
+    typename P::Result mostRecentResult;
+
+    cv::Mat frame;
+    cv::Mat overlay;
+    State state = State::Running;
+    int keyPressed = 0;
+    int count = 0;
+    const auto framePeriod = FramePeriod( );
+    const auto runStart = std::chrono::high_resolution_clock::now( );
+
+    while ( !IsQuitKey( keyPressed ) ) {
+        const auto nextTick = runStart + ( ++count * framePeriod );
+        bool acquired = false;
+        if ( !Advance( keyPressed, state, frame, acquired ) )
+            return;
+        if ( acquired )
+            asyncProcessor.Submit( frame );
+
+        std::this_thread::sleep_until( nextTick );
+
+        if ( asyncProcessor.TryCollect( mostRecentResult ) )
+            overlay = mostRecentResult.Overlay( frame.size( ), frame.type( ) );
+        keyPressed = Display( frame, overlay );
+    }
+}
+
 // ##################################
 
 class ImageStreamer final : public FrameStreamer {
@@ -83,12 +281,67 @@ private:
 
 // ##################################
 
+// * Streams a sequence of images given as a directory, a glob pattern on the file name (e.g. 'data/*.jpg'), a single
+// * image or a manifest file with one image path per line (relative paths are resolved against the manifest
+// * directory). Initialize fails if an entry does not exist. Images are read through memory mapped files and decoded
+// * with cv::imdecode on a thread pool, prefetching ahead of consumption; frames are always returned in sorted /
+// * manifest order, undecodable images are skipped.
+class ImageSequenceStreamer final : public FrameStreamer {
+public:
+    ImageSequenceStreamer(
+        const std::string& source,
+        std::unique_ptr<Logger::ILogger> logger,
+        size_t numberOfThreads = 0,
+        size_t prefetchDepth = 0
+    ) :
+        mIsInitialized( false ),
+        mLogger( std::move( logger ) ),
+        mSource( source ),
+        mNumberOfThreads( numberOfThreads ),
+        mPrefetchDepth( prefetchDepth ),
+        mNextIndex( 0 ),
+        mNextPrefetchIndex( 0 ),
+        mGeneration( 0 )
+    {
+    }
+
+    bool Initialize( ) override;
+
+    bool AcquireNextFrame( cv::Mat& frame ) override;
+
+    bool AcquirePreviousFrame( cv::Mat& frame ) override;
+
+    const std::vector<std::filesystem::path>& ImagePaths( ) const { return mImagePaths; }
+
+private:
+    void Prefetch( );
+
+    void RestartAt( size_t index );
+
+    bool mIsInitialized;
+    std::unique_ptr<Logger::ILogger> mLogger;
+    const std::string mSource;
+    size_t mNumberOfThreads;
+    size_t mPrefetchDepth;
+    std::vector<std::filesystem::path> mImagePaths;
+    size_t mNextIndex;
+    size_t mNextPrefetchIndex;
+    std::deque<std::future<cv::Mat>> mPrefetched;
+    std::atomic<uint64_t> mGeneration; // * Incremented by RestartAt to cancel queued decodes
+    std::unique_ptr<ThreadPool> mDecoders; // * Last, so that it is joined before the members its tasks use
+};
+
+// ##################################
+
+// * The capture is opened and read on a thread of its own that enters the decode stage, one frame ahead of the
+// * display loop
 class VideoStreamer final : public FrameStreamer {
 public:
     VideoStreamer( const std::string& videoFilePath ) :
         mIsInitialized( false ),
         mLoopVideo( true ),
-        mVideoFilePath( videoFilePath )
+        mVideoFilePath( videoFilePath ),
+        mLastIndex( -1 )
     {
     }
 
@@ -99,8 +352,19 @@ public:
     bool AcquirePreviousFrame( cv::Mat& frame ) override;
 
 private:
+    struct DecodedFrame {
+        cv::Mat frame;
+        int index = -1;
+    };
+
+    // * Runs on mDecoder only
+    DecodedFrame ReadFrame( );
+
     bool mIsInitialized;
     const std::string mVideoFilePath;
     const bool mLoopVideo;
     cv::VideoCapture mCap;
+    int mLastIndex; // * Of the frame last acquired
+    std::future<DecodedFrame> mNext;
+    std::unique_ptr<ThreadPool> mDecoder; // * Last, so that it is joined before the members its tasks use
 };
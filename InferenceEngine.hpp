@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+// * Runtime agnostic interface for running a single input / single output float model. Implementations:
+// * OrtInferenceEngine (onnxruntime) and OpenCvDnnInferenceEngine (cv::dnn on the CPU).
+class InferenceEngine {
+public:
+    struct Tensor {
+        std::vector<int64_t> shape;
+        std::vector<float> data;
+    };
+
+    virtual ~InferenceEngine( ) = default;
+
+    virtual bool Initialize( const std::filesystem::path& modelFilePath ) = 0;
+
+    // * NCHW
+    virtual std::vector<int64_t> GetInputShape( ) const = 0;
+
+    // * 'input' holds one tensor of GetInputShape( ), 'output' is resized to the model output; for models with a
+    // * dynamic batch dimension that is the output of the single input, i.e. without the batch dimension.
+    // * Implementations must allow concurrent calls, either natively or by serializing internally.
+    virtual bool Forward( const float* input, Tensor& output ) = 0;
+
+    // * Runs every input, 'outputs' is grown to at least inputs.size( ) and outputs[ i ] is filled as by Forward
+    // * for inputs[ i ]. Engines run models with a dynamic batch dimension as one [ N, C, H, W ] batch; this default,
+    // * also their fallback for models with a fixed batch of 1, calls Forward sequentially.
+    virtual bool ForwardBatch( std::span<const float* const> inputs, std::vector<Tensor>& outputs )
+    {
+        if ( outputs.size( ) < inputs.size( ) )
+            outputs.resize( inputs.size( ) );
+        bool success = true;
+        for ( size_t i = 0; i < inputs.size( ); ++i )
+            success &= Forward( inputs[ i ], outputs[ i ] );
+        return success;
+    }
+
+    virtual std::string Name( ) const = 0;
+
+protected:
+    // * Splits a batched model output of 'shape' into one tensor per input, false unless shape[ 0 ] is outputs.size( )
+    static bool SplitBatch( const float* data, std::span<const int64_t> shape, std::span<Tensor> outputs )
+    {
+        if ( shape.empty( ) || shape[ 0 ] != static_cast<int64_t>( outputs.size( ) ) )
+            return false;
+        size_t valuesPerInput = 1;
+        for ( const int64_t dim : shape.subspan( 1 ) )
+            valuesPerInput *= static_cast<size_t>( dim );
+        for ( size_t i = 0; i < outputs.size( ); ++i ) {
+            outputs[ i ].shape.assign( shape.begin( ) + 1, shape.end( ) );
+            outputs[ i ].data.assign( data + i * valuesPerInput, data + ( i + 1 ) * valuesPerInput );
+        }
+        return true;
+    }
+};
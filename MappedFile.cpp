@@ -0,0 +1,97 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile( const std::filesystem::path& filePath ) : MappedFile( )
+{
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(
+        filePath.c_str( ), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if ( file == INVALID_HANDLE_VALUE )
+        return;
+
+    LARGE_INTEGER size;
+    if ( GetFileSizeEx( file, &size ) ) {
+        mSize = static_cast<size_t>( size.QuadPart );
+        mIsOpen = true;
+        if ( mSize > 0 ) {
+            const HANDLE mapping = CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+            if ( mapping != nullptr ) {
+                mData = static_cast<const unsigned char*>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+                CloseHandle( mapping );
+            }
+            mIsOpen = mData != nullptr;
+        }
+    }
+    CloseHandle( file );
+#else
+    const int file = open( filePath.c_str( ), O_RDONLY );
+    if ( file < 0 )
+        return;
+
+    struct stat status;
+    if ( fstat( file, &status ) == 0 ) {
+        mSize = static_cast<size_t>( status.st_size );
+        mIsOpen = true;
+        if ( mSize > 0 ) {
+            void* data = mmap( nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0 );
+            if ( data != MAP_FAILED ) {
+                madvise( data, mSize, MADV_SEQUENTIAL );
+                mData = static_cast<const unsigned char*>( data );
+            }
+            mIsOpen = mData != nullptr;
+        }
+    }
+    close( file );
+#endif
+    if ( !mIsOpen )
+        mSize = 0;
+}
+
+MappedFile::~MappedFile( )
+{
+    Close( );
+}
+
+MappedFile::MappedFile( MappedFile&& other ) noexcept :
+    mData( std::exchange( other.mData, nullptr ) ),
+    mSize( std::exchange( other.mSize, 0 ) ),
+    mIsOpen( std::exchange( other.mIsOpen, false ) )
+{
+}
+
+MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept
+{
+    if ( this != &other ) {
+        Close( );
+        mData = std::exchange( other.mData, nullptr );
+        mSize = std::exchange( other.mSize, 0 );
+        mIsOpen = std::exchange( other.mIsOpen, false );
+    }
+    return *this;
+}
+
+void MappedFile::Close( )
+{
+    if ( mData != nullptr ) {
+#ifdef _WIN32
+        UnmapViewOfFile( mData );
+#else
+        munmap( const_cast<unsigned char*>( mData ), mSize );
+#endif
+    }
+    mData = nullptr;
+    mSize = 0;
+    mIsOpen = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// * Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile( ) : mData( nullptr ), mSize( 0 ), mIsOpen( false ) { }
+
+    explicit MappedFile( const std::filesystem::path& filePath );
+
+    ~MappedFile( );
+
+    MappedFile( MappedFile&& other ) noexcept;
+    MappedFile& operator=( MappedFile&& other ) noexcept;
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    bool IsOpen( ) const { return mIsOpen; }
+
+    const unsigned char* Data( ) const { return mData; }
+
+    size_t Size( ) const { return mSize; }
+
+private:
+    void Close( );
+
+    const unsigned char* mData;
+    size_t mSize;
+    bool mIsOpen;
+};
@@ -0,0 +1,387 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <format>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace Logger;
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle invalidSocket = INVALID_SOCKET;
+
+void CloseSocket( SocketHandle s )
+{
+    closesocket( s );
+}
+
+int PollSocket( SocketHandle s, int timeoutMs )
+{
+    WSAPOLLFD fd{ .fd = s, .events = POLLRDNORM, .revents = 0 };
+    return WSAPoll( &fd, 1, timeoutMs );
+}
+
+bool InitializeSockets( )
+{
+    static const bool initialized = [ ] {
+        WSADATA data;
+        return WSAStartup( MAKEWORD( 2, 2 ), &data ) == 0;
+    }( );
+    return initialized;
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle invalidSocket = -1;
+
+void CloseSocket( SocketHandle s )
+{
+    close( s );
+}
+
+int PollSocket( SocketHandle s, int timeoutMs )
+{
+    pollfd fd{ .fd = s, .events = POLLIN, .revents = 0 };
+    return poll( &fd, 1, timeoutMs );
+}
+
+bool InitializeSockets( )
+{
+    return true;
+}
+#endif
+
+constexpr int pollIntervalMs = 100;
+constexpr int requestTimeoutMs = 1000;
+
+std::string FormatValue( double value )
+{
+    std::ostringstream ss;
+    ss << value;
+    return ss.str( );
+}
+
+// * Waits up to requestTimeoutMs for the client to send, in poll intervals so that a client which connects and
+// * never sends holds up neither other scrapers nor HttpEndpoint::Stop( ) for long
+bool WaitForRequest( SocketHandle client, const std::atomic<bool>& running )
+{
+    for ( int waitedMs = 0; waitedMs < requestTimeoutMs && running; waitedMs += pollIntervalMs ) {
+        const int ready = PollSocket( client, pollIntervalMs );
+        if ( ready != 0 )
+            return ready > 0;
+    }
+    return false;
+}
+
+// * Returns false if the client sent no request in time
+bool HandleConnection( SocketHandle client, const Metrics::Registry& registry, const std::atomic<bool>& running )
+{
+    if ( !WaitForRequest( client, running ) )
+        return false;
+
+    // * Only the request line is of interest, the endpoint is for scrapers on localhost
+    char request[ 1024 ];
+    const int received = recv( client, request, sizeof( request ) - 1, 0 );
+    if ( received <= 0 )
+        return true;
+    request[ received ] = '\0';
+
+    const std::string_view requestLine( request );
+    std::string status = "404 Not Found";
+    std::string body = "Not Found\n";
+    if ( requestLine.starts_with( "GET /metrics " ) || requestLine.starts_with( "GET / " ) ) {
+        status = "200 OK";
+        body = registry.Serialize( );
+    }
+
+    const std::string response = std::format(
+        "HTTP/1.1 {}\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+        status,
+        body.size( ),
+        body
+    );
+    size_t sent = 0;
+    while ( sent < response.size( ) ) {
+        const int n = send( client, response.data( ) + sent, static_cast<int>( response.size( ) - sent ), 0 );
+        if ( n <= 0 )
+            break;
+        sent += n;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace Metrics {
+
+Histogram::Histogram( const std::vector<double>& upperBounds ) : mUpperBounds( upperBounds )
+{
+    if ( mUpperBounds.size( ) > maxNumberOfBuckets || !std::is_sorted( mUpperBounds.begin( ), mUpperBounds.end( ) ) )
+        throw std::invalid_argument( "Histogram bounds must be sorted and at most maxNumberOfBuckets" );
+}
+
+void Histogram::Observe( double value )
+{
+    size_t bucket = 0;
+    while ( bucket < mUpperBounds.size( ) && value > mUpperBounds[ bucket ] )
+        ++bucket;
+    mBuckets[ bucket ].fetch_add( 1, std::memory_order_relaxed );
+    mSum.fetch_add( value, std::memory_order_relaxed );
+}
+
+uint64_t Histogram::Count( ) const
+{
+    uint64_t count = 0;
+    for ( size_t i = 0; i <= mUpperBounds.size( ); ++i )
+        count += BucketCount( i );
+    return count;
+}
+
+const std::vector<double>& LatencyBuckets( )
+{
+    static const std::vector<double> buckets{ 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1. };
+    return buckets;
+}
+
+// ##################################
+
+Registry::Entry* Registry::Find( const std::string& name, Type type )
+{
+    for ( auto& entry : mEntries ) {
+        if ( entry.name == name ) {
+            if ( entry.type != type )
+                throw std::invalid_argument( "Metric '" + name + "' registered with a different type" );
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Counter& Registry::GetCounter( const std::string& name, const std::string& help )
+{
+    std::scoped_lock lock( mMutex );
+    if ( auto* entry = Find( name, Type::Counter ) )
+        return *entry->counter;
+    return *mEntries
+                .emplace_back(
+                    Entry{ .name = name, .help = help, .type = Type::Counter, .counter = std::make_unique<Counter>( ) }
+                )
+                .counter;
+}
+
+Gauge& Registry::GetGauge( const std::string& name, const std::string& help )
+{
+    std::scoped_lock lock( mMutex );
+    if ( auto* entry = Find( name, Type::Gauge ) )
+        return *entry->gauge;
+    return *mEntries
+                .emplace_back(
+                    Entry{ .name = name, .help = help, .type = Type::Gauge, .gauge = std::make_unique<Gauge>( ) }
+                )
+                .gauge;
+}
+
+Histogram& Registry::GetHistogram(
+    const std::string& name, const std::string& help, const std::vector<double>& upperBounds
+)
+{
+    std::scoped_lock lock( mMutex );
+    if ( auto* entry = Find( name, Type::Histogram ) )
+        return *entry->histogram;
+    return *mEntries
+                .emplace_back( Entry{
+                    .name = name,
+                    .help = help,
+                    .type = Type::Histogram,
+                    .histogram = std::make_unique<Histogram>( upperBounds ) } )
+                .histogram;
+}
+
+std::string Registry::Serialize( ) const
+{
+    std::scoped_lock lock( mMutex );
+    std::string out;
+    for ( const auto& entry : mEntries ) {
+        out += std::format( "# HELP {} {}\n", entry.name, entry.help );
+        switch ( entry.type ) {
+        case Type::Counter:
+            out += std::format( "# TYPE {} counter\n{} {}\n", entry.name, entry.name, entry.counter->Value( ) );
+            break;
+        case Type::Gauge:
+            out += std::format( "# TYPE {} gauge\n{} {}\n", entry.name, entry.name, entry.gauge->Value( ) );
+            break;
+        case Type::Histogram: {
+            const auto& histogram = *entry.histogram;
+            out += std::format( "# TYPE {} histogram\n", entry.name );
+            uint64_t cumulative = 0;
+            for ( size_t i = 0; i < histogram.UpperBounds( ).size( ); ++i ) {
+                cumulative += histogram.BucketCount( i );
+                out += std::format(
+                    "{}_bucket{{le=\"{}\"}} {}\n", entry.name, FormatValue( histogram.UpperBounds( )[ i ] ), cumulative
+                );
+            }
+            cumulative += histogram.BucketCount( histogram.UpperBounds( ).size( ) );
+            out += std::format( "{}_bucket{{le=\"+Inf\"}} {}\n", entry.name, cumulative );
+            out += std::format( "{}_sum {}\n", entry.name, FormatValue( histogram.Sum( ) ) );
+            out += std::format( "{}_count {}\n", entry.name, cumulative );
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+Registry& Registry::Global( )
+{
+    static Registry registry;
+    return registry;
+}
+
+PipelineMetrics& PipelineMetrics::Get( )
+{
+    auto& registry = Registry::Global( );
+    static PipelineMetrics metrics{
+        .inferenceFrames =
+            registry.GetCounter( "yolo_pose_inference_frames_total", "Frames for which a model result was received" ),
+        .displayFrames = registry.GetCounter( "yolo_pose_display_frames_total", "Frames shown by the streamer" ),
+        .droppedFrames = registry.GetCounter(
+            "yolo_pose_dropped_frames_total", "Frames not processed because the previous frame was still in flight"
+        ),
+        .queueDepth = registry.GetGauge( "yolo_pose_queue_depth", "Frames currently being processed" ),
+        .forwardLatency =
+            registry.GetHistogram( "yolo_pose_forward_latency_seconds", "Latency of PoseEstimator::Forward" ),
+        .forwardFailures =
+            registry.GetCounter( "yolo_pose_forward_failures_total", "Failed PoseEstimator::Forward calls" ) };
+    return metrics;
+}
+
+// ##################################
+
+bool HttpEndpoint::Start( uint16_t port )
+{
+    if ( mRunning ) {
+        mLogger->Log( Priority::Warning, "Metrics endpoint already running" );
+        return false;
+    }
+    if ( !InitializeSockets( ) ) {
+        mLogger->Log( Priority::Error, "Sockets could not be initialized" );
+        return false;
+    }
+
+    const SocketHandle listenSocket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+    if ( listenSocket == invalidSocket ) {
+        mLogger->Log( Priority::Error, "Metrics endpoint socket could not be created" );
+        return false;
+    }
+
+    const int reuse = 1;
+    setsockopt( listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>( &reuse ), sizeof( reuse ) );
+
+    sockaddr_in address{ };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    address.sin_port = htons( port );
+    socklen_t addressLength = sizeof( address );
+    if ( bind( listenSocket, reinterpret_cast<sockaddr*>( &address ), addressLength ) != 0
+         || listen( listenSocket, 8 ) != 0
+         || getsockname( listenSocket, reinterpret_cast<sockaddr*>( &address ), &addressLength ) != 0 ) {
+        mLogger->Log( Priority::Error, std::format( "Metrics endpoint could not listen on port {}", port ) );
+        CloseSocket( listenSocket );
+        return false;
+    }
+    mPort = ntohs( address.sin_port );
+    mRunning = true;
+
+    mThread = std::thread( [ this, listenSocket ]( ) {
+        while ( mRunning ) {
+            if ( PollSocket( listenSocket, pollIntervalMs ) <= 0 )
+                continue;
+            const SocketHandle client = accept( listenSocket, nullptr, nullptr );
+            if ( client == invalidSocket )
+                continue;
+            if ( !HandleConnection( client, mRegistry, mRunning ) && mRunning )
+                mLogger->Log( Priority::Debug, "Metrics client sent no request in time, closing the connection" );
+            CloseSocket( client );
+        }
+        CloseSocket( listenSocket );
+    } );
+
+    mLogger->Log( Priority::Info, std::format( "Serving metrics on http://127.0.0.1:{}/metrics", mPort ) );
+    return true;
+}
+
+void HttpEndpoint::Stop( )
+{
+    mRunning = false;
+    if ( mThread.joinable( ) )
+        mThread.join( );
+}
+
+// ##################################
+
+void PeriodicReporter::Start( )
+{
+    if ( mRunning.exchange( true ) )
+        return;
+
+    mThread = std::thread( [ this ]( ) {
+        std::unique_lock lock( mMutex );
+        while ( !mWakeUp.wait_for( lock, mInterval, [ this ] { return !mRunning; } ) )
+            Report( );
+    } );
+}
+
+void PeriodicReporter::Stop( )
+{
+    {
+        std::scoped_lock lock( mMutex );
+        mRunning = false;
+    }
+    mWakeUp.notify_all( );
+    if ( mThread.joinable( ) )
+        mThread.join( );
+}
+
+void PeriodicReporter::Report( )
+{
+    const auto& metrics = PipelineMetrics::Get( );
+    const Snapshot current{
+        .inferenceFrames = metrics.inferenceFrames.Value( ),
+        .displayFrames = metrics.displayFrames.Value( ),
+        .droppedFrames = metrics.droppedFrames.Value( ),
+        .forwardCount = metrics.forwardLatency.Count( ),
+        .forwardSum = metrics.forwardLatency.Sum( ) };
+
+    const double seconds = std::chrono::duration<double>( mInterval ).count( );
+    const uint64_t forwardCalls = current.forwardCount - mPrevious.forwardCount;
+    const double forwardMs =
+        forwardCalls > 0 ? 1000. * ( current.forwardSum - mPrevious.forwardSum ) / forwardCalls : 0.;
+    mLogger->Log(
+        Priority::Info,
+        std::format(
+            "inference fps {:.1f}, display fps {:.1f}, dropped frames {}, queue depth {}, forward {:.2f} ms",
+            ( current.inferenceFrames - mPrevious.inferenceFrames ) / seconds,
+            ( current.displayFrames - mPrevious.displayFrames ) / seconds,
+            current.droppedFrames - mPrevious.droppedFrames,
+            metrics.queueDepth.Value( ),
+            forwardMs
+        )
+    );
+    mPrevious = current;
+}
+
+} // namespace Metrics
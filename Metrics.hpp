@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Logger.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// * Lock-free counters, gauges and histograms which can be updated from the pipeline hot paths, exposed in the
+// * Prometheus text format through a small local http endpoint and / or a periodic log line. Registration takes a
+// * lock and should happen once, the returned references stay valid for the lifetime of the registry.
+namespace Metrics {
+
+class Counter {
+public:
+    void Increment( uint64_t n = 1 ) { mValue.fetch_add( n, std::memory_order_relaxed ); }
+
+    uint64_t Value( ) const { return mValue.load( std::memory_order_relaxed ); }
+
+private:
+    std::atomic<uint64_t> mValue = 0;
+};
+
+class Gauge {
+public:
+    void Set( int64_t value ) { mValue.store( value, std::memory_order_relaxed ); }
+
+    void Add( int64_t n ) { mValue.fetch_add( n, std::memory_order_relaxed ); }
+
+    int64_t Value( ) const { return mValue.load( std::memory_order_relaxed ); }
+
+private:
+    std::atomic<int64_t> mValue = 0;
+};
+
+class Histogram {
+public:
+    static constexpr size_t maxNumberOfBuckets = 16;
+
+    // * Upper bounds in ascending order, an implicit +Inf bucket is added
+    explicit Histogram( const std::vector<double>& upperBounds );
+
+    void Observe( double value );
+
+    uint64_t Count( ) const;
+
+    double Sum( ) const { return mSum.load( std::memory_order_relaxed ); }
+
+    const std::vector<double>& UpperBounds( ) const { return mUpperBounds; }
+
+    // * Non-cumulative count of bucket 'index', index UpperBounds( ).size( ) is the +Inf bucket
+    uint64_t BucketCount( size_t index ) const { return mBuckets[ index ].load( std::memory_order_relaxed ); }
+
+private:
+    const std::vector<double> mUpperBounds;
+    std::array<std::atomic<uint64_t>, maxNumberOfBuckets + 1> mBuckets{ };
+    std::atomic<double> mSum = 0.;
+};
+
+// * Default latency buckets in seconds, 1 ms to 1 s
+const std::vector<double>& LatencyBuckets( );
+
+class Registry {
+public:
+    Counter& GetCounter( const std::string& name, const std::string& help );
+
+    Gauge& GetGauge( const std::string& name, const std::string& help );
+
+    Histogram& GetHistogram(
+        const std::string& name, const std::string& help, const std::vector<double>& upperBounds = LatencyBuckets( )
+    );
+
+    std::string Serialize( ) const;
+
+    // * Process wide registry used by the pipeline
+    static Registry& Global( );
+
+private:
+    enum class Type {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Entry* Find( const std::string& name, Type type );
+
+    mutable std::mutex mMutex;
+    std::deque<Entry> mEntries;
+};
+
+// * Metrics updated by FrameStreamer and PoseEstimator, registered in Registry::Global( )
+struct PipelineMetrics {
+    Counter& inferenceFrames;
+    Counter& displayFrames;
+    Counter& droppedFrames;
+    Gauge& queueDepth;
+    Histogram& forwardLatency;
+    Counter& forwardFailures;
+
+    static PipelineMetrics& Get( );
+};
+
+// ##################################
+
+// * Serves Registry::Serialize( ) on http://127.0.0.1:<port>/metrics from a background thread
+class HttpEndpoint {
+public:
+    HttpEndpoint( const Registry& registry, std::unique_ptr<Logger::ILogger> logger ) :
+        mRegistry( registry ),
+        mLogger( std::move( logger ) ),
+        mPort( 0 ),
+        mRunning( false )
+    {
+    }
+
+    ~HttpEndpoint( ) { Stop( ); }
+
+    // * Port 0 picks a free port, see Port( )
+    bool Start( uint16_t port );
+
+    void Stop( );
+
+    uint16_t Port( ) const { return mPort; }
+
+private:
+    const Registry& mRegistry;
+    std::unique_ptr<Logger::ILogger> mLogger;
+    uint16_t mPort;
+    std::atomic<bool> mRunning;
+    std::thread mThread;
+};
+
+// * Logs throughput of the PipelineMetrics every 'interval' from a background thread
+class PeriodicReporter {
+public:
+    PeriodicReporter( std::unique_ptr<Logger::ILogger> logger, std::chrono::milliseconds interval ) :
+        mLogger( std::move( logger ) ),
+        mInterval( interval ),
+        mRunning( false )
+    {
+    }
+
+    ~PeriodicReporter( ) { Stop( ); }
+
+    void Start( );
+
+    void Stop( );
+
+private:
+    struct Snapshot {
+        uint64_t inferenceFrames = 0;
+        uint64_t displayFrames = 0;
+        uint64_t droppedFrames = 0;
+        uint64_t forwardCount = 0;
+        double forwardSum = 0.;
+    };
+
+    void Report( );
+
+    std::unique_ptr<Logger::ILogger> mLogger;
+    const std::chrono::milliseconds mInterval;
+    std::atomic<bool> mRunning;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::thread mThread;
+    Snapshot mPrevious;
+};
+
+} // namespace Metrics
@@ -0,0 +1,264 @@
+#include "OpenCvDnnInferenceEngine.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <format>
+#include <optional>
+#include <string_view>
+
+#include <opencv2/core/version.hpp>
+
+using namespace Logger;
+
+namespace {
+
+// * Minimal protobuf reader, used to get the declared input shape of the onnx model since cv::dnn::Net does
+// * not expose it
+class ProtoReader {
+public:
+    ProtoReader( const unsigned char* data, size_t size ) : mData( data ), mEnd( data + size ) { }
+
+    // * Advances to the next field, returns false at the end or on malformed input
+    bool Next( int& number, int& wireType, uint64_t& varint, ProtoReader& message )
+    {
+        if ( mData >= mEnd )
+            return false;
+        uint64_t tag;
+        if ( !ReadVarint( tag ) )
+            return false;
+        number = static_cast<int>( tag >> 3 );
+        wireType = static_cast<int>( tag & 0x7 );
+        switch ( wireType ) {
+        case 0:
+            return ReadVarint( varint );
+        case 1:
+            return Skip( 8 );
+        case 2: {
+            uint64_t length;
+            if ( !ReadVarint( length ) || length > static_cast<uint64_t>( mEnd - mData ) )
+                return false;
+            message = ProtoReader( mData, length );
+            return Skip( length );
+        }
+        case 5:
+            return Skip( 4 );
+        default:
+            return false;
+        }
+    }
+
+    std::string_view AsString( ) const
+    {
+        return { reinterpret_cast<const char*>( mData ), static_cast<size_t>( mEnd - mData ) };
+    }
+
+private:
+    bool ReadVarint( uint64_t& value )
+    {
+        value = 0;
+        for ( int shift = 0; shift < 64 && mData < mEnd; shift += 7 ) {
+            const unsigned char byte = *mData++;
+            value |= static_cast<uint64_t>( byte & 0x7F ) << shift;
+            if ( ( byte & 0x80 ) == 0 )
+                return true;
+        }
+        return false;
+    }
+
+    bool Skip( uint64_t n )
+    {
+        if ( n > static_cast<uint64_t>( mEnd - mData ) )
+            return false;
+        mData += n;
+        return true;
+    }
+
+    const unsigned char* mData;
+    const unsigned char* mEnd;
+};
+
+// * Finds field 'number' of wire type 2 in 'reader', returns the first occurrence
+std::optional<ProtoReader> FindMessage( ProtoReader reader, int number )
+{
+    int fieldNumber;
+    int wireType;
+    uint64_t varint;
+    ProtoReader message( nullptr, 0 );
+    while ( reader.Next( fieldNumber, wireType, varint, message ) ) {
+        if ( fieldNumber == number && wireType == 2 )
+            return message;
+    }
+    return std::nullopt;
+}
+
+// * ModelProto.graph -> GraphProto.input[ 0 ] -> ValueInfoProto.type -> TypeProto.tensor_type -> .shape -> dims
+std::vector<int64_t> ReadOnnxInputShape( const std::filesystem::path& modelFilePath )
+{
+    const MappedFile file( modelFilePath );
+    if ( !file.IsOpen( ) )
+        return { };
+
+    auto graph = FindMessage( ProtoReader( file.Data( ), file.Size( ) ), 7 );
+    auto input = graph ? FindMessage( *graph, 11 ) : std::nullopt;
+    auto type = input ? FindMessage( *input, 2 ) : std::nullopt;
+    auto tensorType = type ? FindMessage( *type, 1 ) : std::nullopt;
+    auto shape = tensorType ? FindMessage( *tensorType, 2 ) : std::nullopt;
+    if ( !shape )
+        return { };
+
+    std::vector<int64_t> dims;
+    int fieldNumber;
+    int wireType;
+    uint64_t varint;
+    ProtoReader dim( nullptr, 0 );
+    while ( shape->Next( fieldNumber, wireType, varint, dim ) ) {
+        if ( fieldNumber != 1 || wireType != 2 )
+            continue;
+        // * Symbolic dimensions ( dim_param ) are reported as -1
+        int64_t value = -1;
+        int dimField;
+        int dimWireType;
+        uint64_t dimValue;
+        ProtoReader unused( nullptr, 0 );
+        while ( dim.Next( dimField, dimWireType, dimValue, unused ) ) {
+            if ( dimField == 1 && dimWireType == 0 )
+                value = static_cast<int64_t>( dimValue );
+        }
+        dims.push_back( value );
+    }
+    return dims;
+}
+
+} // namespace
+
+bool OpenCvDnnInferenceEngine::Initialize( const std::filesystem::path& modelFilePath )
+{
+    std::scoped_lock lock( mMutex );
+    mInputShape = ReadOnnxInputShape( modelFilePath );
+    if ( mInputShape.size( ) != 4 || mInputShape[ 1 ] <= 0 ) {
+        mLogger.Log( Priority::Error, "Could not read an NCHW input shape with static channels from the model" );
+        return false;
+    }
+    // * Forward runs one image at a time and ForwardBatch any number with a dynamic batch dimension
+    mDynamicBatch = mInputShape[ 0 ] == -1;
+    if ( mDynamicBatch ) {
+        mLogger.Log( Priority::Info, "Model has a dynamic batch dimension, ForwardBatch runs inputs as one batch" );
+        mInputShape[ 0 ] = 1;
+    }
+    else if ( mInputShape[ 0 ] != 1 ) {
+        mLogger.Log(
+            Priority::Error,
+            std::format( "Model has a static batch of {}, only a batch of 1 is supported", mInputShape[ 0 ] )
+        );
+        return false;
+    }
+    // * Symbolic spatial dimensions default to the exported yolo-pose resolution
+    if ( mInputShape[ 2 ] == -1 || mInputShape[ 3 ] == -1 ) {
+        mInputShape[ 2 ] = mInputShape[ 2 ] == -1 ? 640 : mInputShape[ 2 ];
+        mInputShape[ 3 ] = mInputShape[ 3 ] == -1 ? 640 : mInputShape[ 3 ];
+        mLogger.Log(
+            Priority::Warning,
+            std::format(
+                "Model has symbolic spatial input dimensions, running at {}x{}", mInputShape[ 3 ], mInputShape[ 2 ]
+            )
+        );
+    }
+
+    try {
+        mNet = cv::dnn::readNetFromONNX( modelFilePath.string( ) );
+        if ( mNet.empty( ) ) {
+            mLogger.Log( Priority::Error, "OpenCV dnn could not load the model" );
+            return false;
+        }
+        mNet.setPreferableBackend( cv::dnn::DNN_BACKEND_OPENCV );
+        switch ( mTarget ) {
+        case Target::Cpu:
+            mNet.setPreferableTarget( cv::dnn::DNN_TARGET_CPU );
+            break;
+        case Target::CpuFp16:
+#if CV_VERSION_MAJOR > 4 || ( CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9 )
+            mNet.setPreferableTarget( cv::dnn::DNN_TARGET_CPU_FP16 );
+#else
+            mLogger.Log( Priority::Warning, "DNN_TARGET_CPU_FP16 requires OpenCV 4.9, falling back to DNN_TARGET_CPU" );
+            mNet.setPreferableTarget( cv::dnn::DNN_TARGET_CPU );
+#endif
+            break;
+        }
+    }
+    catch ( const std::exception& e ) {
+        mLogger.Log( Priority::Error, e.what( ) );
+        return false;
+    }
+    mLogger.Log( Priority::Info, "OpenCV dnn backend initialized" );
+    return true;
+}
+
+bool OpenCvDnnInferenceEngine::Forward( const float* input, Tensor& output )
+{
+    const int shape[] = {
+        static_cast<int>( mInputShape[ 0 ] ),
+        static_cast<int>( mInputShape[ 1 ] ),
+        static_cast<int>( mInputShape[ 2 ] ),
+        static_cast<int>( mInputShape[ 3 ] ) };
+    // * Wraps the caller's buffer, setInput copies it into the network
+    const cv::Mat blob( 4, shape, CV_32F, const_cast<float*>( input ) );
+
+    std::scoped_lock lock( mMutex );
+    return Run( blob, std::span<Tensor>( &output, 1 ) );
+}
+
+bool OpenCvDnnInferenceEngine::ForwardBatch( std::span<const float* const> inputs, std::vector<Tensor>& outputs )
+{
+    if ( !mDynamicBatch || inputs.size( ) <= 1 )
+        return InferenceEngine::ForwardBatch( inputs, outputs );
+
+    const int shape[] = {
+        static_cast<int>( inputs.size( ) ),
+        static_cast<int>( mInputShape[ 1 ] ),
+        static_cast<int>( mInputShape[ 2 ] ),
+        static_cast<int>( mInputShape[ 3 ] ) };
+    const size_t inputSize = static_cast<size_t>( shape[ 1 ] ) * shape[ 2 ] * shape[ 3 ];
+    if ( outputs.size( ) < inputs.size( ) )
+        outputs.resize( inputs.size( ) );
+
+    std::scoped_lock lock( mMutex );
+    mBatchBlob.create( 4, shape, CV_32F );
+    float* const batch = mBatchBlob.ptr<float>( );
+    for ( size_t i = 0; i < inputs.size( ); ++i )
+        std::copy_n( inputs[ i ], inputSize, batch + i * inputSize );
+    return Run( mBatchBlob, std::span<Tensor>( outputs ).first( inputs.size( ) ) );
+}
+
+std::string OpenCvDnnInferenceEngine::Name( ) const
+{
+    return mTarget == Target::CpuFp16 ? "opencv-dnn-cpu-fp16" : "opencv-dnn-cpu";
+}
+
+bool OpenCvDnnInferenceEngine::Run( const cv::Mat& blob, std::span<Tensor> outputs )
+{
+    try {
+        mNet.setInput( blob );
+        const cv::Mat result = mNet.forward( );
+        if ( result.empty( ) || result.depth( ) != CV_32F )
+            return false;
+
+        const cv::Mat continuous = result.isContinuous( ) ? result : result.clone( );
+        const float* data = continuous.ptr<float>( );
+        if ( !mDynamicBatch ) {
+            outputs[ 0 ].shape.assign( result.size.p, result.size.p + result.dims );
+            outputs[ 0 ].data.assign( data, data + continuous.total( ) );
+        }
+        else {
+            const std::vector<int64_t> shape( result.size.p, result.size.p + result.dims );
+            if ( !SplitBatch( data, shape, outputs ) ) {
+                mLogger.Log( Priority::Error, "Model output does not have a leading batch dimension" );
+                return false;
+            }
+        }
+    }
+    catch ( const std::exception& e ) {
+        mLogger.Log( Priority::Error, e.what( ) );
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "InferenceEngine.hpp"
+#include "Logger.hpp"
+
+#include <mutex>
+
+#include <opencv2/dnn.hpp>
+
+// * cv::dnn::Net is not safe for concurrent forward passes, calls are serialized and rely on the internal
+// * parallelization of the OpenCV layers instead
+class OpenCvDnnInferenceEngine final : public InferenceEngine {
+public:
+    enum class Target {
+        Cpu,
+        CpuFp16 // * Requires OpenCV 4.9 or later
+    };
+
+    OpenCvDnnInferenceEngine( Logger::ILogger& logger, Target target ) : mLogger( logger ), mTarget( target ) { }
+
+    bool Initialize( const std::filesystem::path& modelFilePath ) override;
+
+    std::vector<int64_t> GetInputShape( ) const override { return mInputShape; }
+
+    bool Forward( const float* input, Tensor& output ) override;
+
+    bool ForwardBatch( std::span<const float* const> inputs, std::vector<Tensor>& outputs ) override;
+
+    std::string Name( ) const override;
+
+private:
+    Logger::ILogger& mLogger;
+    const Target mTarget;
+    std::mutex mMutex;
+    cv::dnn::Net mNet;
+    std::vector<int64_t> mInputShape;
+    bool mDynamicBatch = false; // * The model batch dimension is symbolic, mInputShape holds a batch of 1
+    cv::Mat mBatchBlob;         // * Reused [ N, C, H, W ] input of ForwardBatch, guarded by mMutex
+
+    // * Runs 'blob' holding 'outputs.size( )' inputs, with mMutex held
+    bool Run( const cv::Mat& blob, std::span<Tensor> outputs );
+};
@@ -0,0 +1,230 @@
+#include "OrtInferenceEngine.hpp"
+#include "CpuAffinity.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+using namespace Logger;
+
+namespace {
+
+bool InitializeCudaBackend( Ort::SessionOptions& sessionOptions )
+{
+    auto& ortApi = Ort::GetApi( );
+    OrtCUDAProviderOptionsV2* pCudaOptions = nullptr;
+    ortApi.CreateCUDAProviderOptions( &pCudaOptions );
+    std::unique_ptr<OrtCUDAProviderOptionsV2, decltype( ortApi.ReleaseCUDAProviderOptions )> cudaOptions(
+        pCudaOptions, ortApi.ReleaseCUDAProviderOptions
+    );
+    std::vector<const char*> keys{ "device_id", "cudnn_conv_use_max_workspace", "do_copy_in_default_stream" };
+    std::vector<const char*> values{ "0", "0", "1" };
+    ortApi.UpdateCUDAProviderOptions( cudaOptions.get( ), keys.data( ), values.data( ), keys.size( ) );
+    return nullptr == ortApi.SessionOptionsAppendExecutionProvider_CUDA_V2( sessionOptions, cudaOptions.get( ) );
+}
+
+bool InitializeTensorRTBackend( Ort::SessionOptions& sessionOptions, const std::string& engineCachePath )
+{
+    auto& ortApi = Ort::GetApi( );
+    OrtTensorRTProviderOptionsV2* pTrtOptions = nullptr;
+    ortApi.CreateTensorRTProviderOptions( &pTrtOptions );
+    std::unique_ptr<OrtTensorRTProviderOptionsV2, decltype( ortApi.ReleaseTensorRTProviderOptions )> trtOptions(
+        pTrtOptions, ortApi.ReleaseTensorRTProviderOptions
+    );
+    std::vector<const char*> trtKeys{
+        "device_id",
+        "trt_fp16_enable",
+        "trt_dla_enable",
+        "trt_dla_core",
+        "trt_engine_cache_enable",
+        "trt_engine_cache_path" };
+    std::vector<const char*> trtValues{ "0", "1", "0", "1", "1", engineCachePath.c_str( ) };
+    ortApi.UpdateTensorRTProviderOptions( trtOptions.get( ), trtKeys.data( ), trtValues.data( ), trtKeys.size( ) );
+    return nullptr == ortApi.SessionOptionsAppendExecutionProvider_TensorRT_V2( sessionOptions, trtOptions.get( ) );
+}
+
+// * onnxruntime creates its intra-op pool threads through these hooks, which pin them to the inference CPUs
+OrtCustomThreadHandle CreateInferenceThread( void*, OrtThreadWorkerFn work, void* parameter )
+{
+    auto* thread = new std::thread( [ work, parameter ]( ) {
+        auto& partition = CpuAffinity::Partition::Global( );
+        partition.Enter( CpuAffinity::Stage::Inference );
+        work( parameter );
+        // * Pool threads live as long as the session, sample the CPU again once they are done
+        partition.Record( CpuAffinity::Stage::Inference );
+    } );
+    return reinterpret_cast<OrtCustomThreadHandle>( thread );
+}
+
+void JoinInferenceThread( OrtCustomThreadHandle handle )
+{
+    auto* thread = reinterpret_cast<std::thread*>( const_cast<OrtCustomHandleType*>( handle ) );
+    thread->join( );
+    delete thread;
+}
+
+} // namespace
+
+bool OrtInferenceEngine::Initialize( const std::filesystem::path& modelFilePath )
+{
+    mEnv = Ort::Env( OrtLoggingLevel::ORT_LOGGING_LEVEL_WARNING, mInstanceName.c_str( ) );
+
+    Ort::SessionOptions sessionOptions;
+    switch ( mProvider ) {
+    case ExecutionProvider::Cpu:
+        mLogger.Log( Priority::Info, "Cpu backend initialized" );
+        break;
+    case ExecutionProvider::Cuda:
+        if ( !InitializeCudaBackend( sessionOptions ) ) {
+            mLogger.Log( Priority::Error, "Cuda backend could not be initialized" );
+            return false;
+        }
+        mLogger.Log( Priority::Info, "Cuda backend initialized" );
+        break;
+    case ExecutionProvider::TensorRT:
+        if ( !InitializeTensorRTBackend( sessionOptions, "C:\\tmp\\" ) ) {
+            mLogger.Log( Priority::Error, "TensorRT backend could not be initialized" );
+            return false;
+        }
+        mLogger.Log( Priority::Info, "TensorRT backend initialized" );
+        break;
+    }
+
+    // * Pool threads inherit the affinity of the thread creating the session, which with a pinned layout may be a
+    // * thread of another stage, so the hooks are installed whenever the layout is pinned. Entering the inference
+    // * stage without inference CPUs resets them to the unpinned CPUs.
+    const CpuAffinity::Layout& layout = CpuAffinity::Partition::Global( ).GetLayout( );
+    const CpuAffinity::CpuSet& inferenceCpus = layout[ CpuAffinity::Stage::Inference ];
+    if ( layout.IsPinned( ) ) {
+        sessionOptions.SetCustomCreateThreadFn( CreateInferenceThread );
+        sessionOptions.SetCustomJoinThreadFn( JoinInferenceThread );
+    }
+    if ( !inferenceCpus.empty( ) ) {
+        // * One pool thread per inference CPU, the calling thread is the extra one and stays on the preprocess CPUs
+        sessionOptions.SetIntraOpNumThreads( static_cast<int>( inferenceCpus.size( ) ) + 1 );
+        mLogger.Log( Priority::Info, "Intra-op threads pinned to cpus " + CpuAffinity::ToString( inferenceCpus ) );
+    }
+
+    try {
+        mSession = Ort::Session( mEnv, modelFilePath.c_str( ), sessionOptions );
+        LoadModelParameters( );
+    }
+    catch ( const std::exception& e ) {
+        mLogger.Log( Priority::Error, e.what( ) );
+        return false;
+    }
+    return true;
+}
+
+bool OrtInferenceEngine::Forward( const float* input, Tensor& output )
+{
+    return Run( input, std::span<Tensor>( &output, 1 ) );
+}
+
+bool OrtInferenceEngine::ForwardBatch( std::span<const float* const> inputs, std::vector<Tensor>& outputs )
+{
+    if ( !mDynamicBatch || inputs.size( ) <= 1 )
+        return InferenceEngine::ForwardBatch( inputs, outputs );
+
+    const size_t inputSize = InputSize( );
+    std::vector<float> batch( inputs.size( ) * inputSize );
+    for ( size_t i = 0; i < inputs.size( ); ++i )
+        std::copy_n( inputs[ i ], inputSize, batch.data( ) + i * inputSize );
+    if ( outputs.size( ) < inputs.size( ) )
+        outputs.resize( inputs.size( ) );
+    return Run( batch.data( ), std::span<Tensor>( outputs ).first( inputs.size( ) ) );
+}
+
+std::string OrtInferenceEngine::Name( ) const
+{
+    switch ( mProvider ) {
+    case ExecutionProvider::Cpu:
+        return "onnxruntime-cpu";
+    case ExecutionProvider::Cuda:
+        return "onnxruntime-cuda";
+    case ExecutionProvider::TensorRT:
+        return "onnxruntime-tensorrt";
+    }
+    return "onnxruntime";
+}
+
+void OrtInferenceEngine::LoadModelParameters( )
+{
+    mMp = { };
+    Ort::AllocatorWithDefaultOptions allocator;
+    mMp.numInputNodes = mSession.GetInputCount( );
+    for ( size_t idx = 0; idx < mMp.numInputNodes; ++idx ) {
+        mMp.inputNodeNamesAllocated.push_back( mSession.GetInputNameAllocated( idx, allocator ) );
+        mMp.inputNodeNames.push_back( mMp.inputNodeNamesAllocated.back( ).get( ) );
+    }
+
+    mMp.numOutputNodes = mSession.GetOutputCount( );
+    for ( size_t idx = 0; idx < mMp.numOutputNodes; ++idx ) {
+        mMp.outputNodeNamesAllocated.push_back( mSession.GetOutputNameAllocated( idx, allocator ) );
+        mMp.outputNodeNames.push_back( mMp.outputNodeNamesAllocated.back( ).get( ) );
+    }
+
+    mMp.inputTensorShape = mSession.GetInputTypeInfo( 0 ).GetTensorTypeAndShapeInfo( ).GetShape( );
+
+    // * Symbolic batch dimensions are reported as -1, Forward runs a single input and ForwardBatch any number
+    mDynamicBatch = !mMp.inputTensorShape.empty( ) && mMp.inputTensorShape[ 0 ] == -1;
+    if ( mDynamicBatch ) {
+        mMp.inputTensorShape[ 0 ] = 1;
+        mLogger.Log( Priority::Info, "Model has a dynamic batch dimension, ForwardBatch runs inputs as one batch" );
+    }
+}
+
+size_t OrtInferenceEngine::InputSize( ) const
+{
+    return std::accumulate(
+        mMp.inputTensorShape.begin( ), mMp.inputTensorShape.end( ), size_t{ 1 }, std::multiplies<size_t>( )
+    );
+}
+
+bool OrtInferenceEngine::Run( const float* input, std::span<Tensor> outputs )
+{
+    std::vector<int64_t> batchShape;
+    const std::vector<int64_t>* inputShape = &mMp.inputTensorShape;
+    if ( outputs.size( ) != 1 ) {
+        batchShape = mMp.inputTensorShape;
+        batchShape[ 0 ] = static_cast<int64_t>( outputs.size( ) );
+        inputShape = &batchShape;
+    }
+
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu( OrtDeviceAllocator, OrtMemTypeDefault );
+    // * onnxruntime does not write to input tensors
+    const Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+        memoryInfo,
+        const_cast<float*>( input ),
+        InputSize( ) * outputs.size( ),
+        inputShape->data( ),
+        inputShape->size( )
+    );
+    try {
+        std::vector<Ort::Value> outputTensors = mSession.Run(
+            Ort::RunOptions{ nullptr },
+            mMp.inputNodeNames.data( ),
+            &inputTensor,
+            mMp.numInputNodes,
+            mMp.outputNodeNames.data( ),
+            mMp.numOutputNodes
+        );
+        auto typeAndShapeInfo = outputTensors.front( ).GetTensorTypeAndShapeInfo( );
+        const float* outputData = outputTensors.front( ).GetTensorData<float>( );
+        if ( outputData == nullptr )
+            return false;
+        if ( !mDynamicBatch ) {
+            outputs[ 0 ].shape = typeAndShapeInfo.GetShape( );
+            outputs[ 0 ].data.assign( outputData, outputData + typeAndShapeInfo.GetElementCount( ) );
+        }
+        else if ( !SplitBatch( outputData, typeAndShapeInfo.GetShape( ), outputs ) ) {
+            mLogger.Log( Priority::Error, "Model output does not have a leading batch dimension" );
+            return false;
+        }
+    }
+    catch ( const std::exception& e ) {
+        mLogger.Log( Priority::Error, e.what( ) );
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "InferenceEngine.hpp"
+#include "Logger.hpp"
+
+#include <onnxruntime_cxx_api.h>
+
+class OrtInferenceEngine final : public InferenceEngine {
+public:
+    enum class ExecutionProvider {
+        Cpu,
+        Cuda,
+        TensorRT
+    };
+
+    OrtInferenceEngine( Logger::ILogger& logger, ExecutionProvider provider, const std::string& instanceName ) :
+        mLogger( logger ),
+        mProvider( provider ),
+        mInstanceName( instanceName ),
+        mEnv( nullptr ),
+        mSession( nullptr )
+    {
+    }
+
+    bool Initialize( const std::filesystem::path& modelFilePath ) override;
+
+    std::vector<int64_t> GetInputShape( ) const override { return mMp.inputTensorShape; }
+
+    bool Forward( const float* input, Tensor& output ) override;
+
+    bool ForwardBatch( std::span<const float* const> inputs, std::vector<Tensor>& outputs ) override;
+
+    std::string Name( ) const override;
+
+private:
+    Logger::ILogger& mLogger;
+    const ExecutionProvider mProvider;
+    const std::string mInstanceName;
+    Ort::Env mEnv;
+    Ort::Session mSession;
+
+    struct ModelParameters {
+        size_t numInputNodes;
+        size_t numOutputNodes;
+        std::vector<Ort::AllocatedStringPtr> inputNodeNamesAllocated;
+        std::vector<const char*> inputNodeNames;
+        std::vector<Ort::AllocatedStringPtr> outputNodeNamesAllocated;
+        std::vector<const char*> outputNodeNames;
+        std::vector<int64_t> inputTensorShape;
+    };
+
+    ModelParameters mMp;
+    bool mDynamicBatch = false; // * The model batch dimension is symbolic, GetInputShape( ) reports a batch of 1
+
+    void LoadModelParameters( );
+
+    size_t InputSize( ) const;
+
+    // * Runs 'outputs.size( )' inputs stored back to back in 'input'
+    bool Run( const float* input, std::span<Tensor> outputs );
+};
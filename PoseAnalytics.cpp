@@ -0,0 +1,317 @@
+#include "PoseAnalytics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numbers>
+#include <thread>
+#include <utility>
+
+namespace {
+
+using namespace PoseAnalytics;
+using Detection = PoseEstimator::Detection;
+
+constexpr float notANumber = std::numeric_limits<float>::quiet_NaN( );
+constexpr float pi = std::numbers::pi_v<float>;
+constexpr float halfPi = pi / 2.f;
+
+// * Frames per work item, bounds the size of the structure-of-arrays scratch buffers
+constexpr size_t framesPerBlock = 1024;
+
+struct BatchView {
+    std::array<float*, numberOfBones> boneLengths;
+    std::array<float*, numberOfJointAngles> jointAngles;
+    float* motionEnergy;
+};
+
+BatchView MakeView( AnalyticsBatch& batch, size_t offset )
+{
+    BatchView view;
+    for ( size_t i = 0; i < numberOfBones; ++i )
+        view.boneLengths[ i ] = batch.boneLengths[ i ].data( ) + offset;
+    for ( size_t i = 0; i < numberOfJointAngles; ++i )
+        view.jointAngles[ i ] = batch.jointAngles[ i ].data( ) + offset;
+    view.motionEnergy = batch.motionEnergy.data( ) + offset;
+    return view;
+}
+
+float Iou( const PoseEstimator::BoundingBox& a, const PoseEstimator::BoundingBox& b )
+{
+    const float w = std::min( a.brX, b.brX ) - std::max( a.tlX, b.tlX );
+    const float h = std::min( a.brY, b.brY ) - std::max( a.tlY, b.tlY );
+    if ( w <= 0.f || h <= 0.f )
+        return 0.f;
+    const float intersection = w * h;
+    const float areaA = ( a.brX - a.tlX ) * ( a.brY - a.tlY );
+    const float areaB = ( b.brX - b.tlX ) * ( b.brY - b.tlY );
+    return intersection / ( areaA + areaB - intersection );
+}
+
+const Detection* MatchPrevious( const Detection& detection, const std::vector<Detection>* previous, float minimumIou )
+{
+    if ( previous == nullptr )
+        return nullptr;
+
+    const Detection* bestMatch = nullptr;
+    float bestIou = 0.f;
+    for ( const auto& candidate : *previous ) {
+        const float iou = Iou( detection.box, candidate.box );
+        if ( iou >= minimumIou && iou > bestIou ) {
+            bestIou = iou;
+            bestMatch = &candidate;
+        }
+    }
+    return bestMatch;
+}
+
+void Gather( KeyPointBatch& batch, size_t index, const Detection& detection )
+{
+    for ( size_t j = 0; j < numberOfJoints; ++j ) {
+        batch.x[ j ][ index ] = detection.keyPoints[ j ].x;
+        batch.y[ j ][ index ] = detection.keyPoints[ j ].y;
+        batch.score[ j ][ index ] = detection.keyPoints[ j ].score;
+    }
+}
+
+void GatherUnmatched( KeyPointBatch& batch, size_t index )
+{
+    for ( size_t j = 0; j < numberOfJoints; ++j ) {
+        batch.x[ j ][ index ] = 0.f;
+        batch.y[ j ][ index ] = 0.f;
+        batch.score[ j ][ index ] = -1.f;
+    }
+}
+
+// ##################################
+
+template <size_t Bone>
+void BoneLengthKernel( const KeyPointBatch& keyPoints, float* out, size_t n, float threshold )
+{
+    constexpr auto from = PoseEstimator::skeleton[ Bone ].first;
+    constexpr auto to = PoseEstimator::skeleton[ Bone ].second;
+    const float* fx = keyPoints.x[ from ].data( );
+    const float* fy = keyPoints.y[ from ].data( );
+    const float* fs = keyPoints.score[ from ].data( );
+    const float* tx = keyPoints.x[ to ].data( );
+    const float* ty = keyPoints.y[ to ].data( );
+    const float* ts = keyPoints.score[ to ].data( );
+
+    for ( size_t i = 0; i < n; ++i ) {
+        const float dx = tx[ i ] - fx[ i ];
+        const float dy = ty[ i ] - fy[ i ];
+        const float length = std::sqrt( dx * dx + dy * dy );
+        out[ i ] = ( ( fs[ i ] >= threshold ) & ( ts[ i ] >= threshold ) ) ? length : notANumber;
+    }
+}
+
+// * The angle is atan2( |cross|, dot ), i.e. in [ 0, pi ], evaluated with a minimax polynomial for atan on [ 0, 1 ]
+// * (max. error ~2e-6 rad) folded into the other octants. std::atan2 is a library call which keeps the loop scalar;
+// * the polynomial is written out in the loop since a helper is not reliably inlined into all instantiations.
+template <size_t Angle>
+void JointAngleKernel( const KeyPointBatch& keyPoints, float* out, size_t n, float threshold )
+{
+    constexpr JointAngle angle = jointAngles[ Angle ];
+    const float* cx = keyPoints.x[ angle.center ].data( );
+    const float* cy = keyPoints.y[ angle.center ].data( );
+    const float* cs = keyPoints.score[ angle.center ].data( );
+    const float* fx = keyPoints.x[ angle.from ].data( );
+    const float* fy = keyPoints.y[ angle.from ].data( );
+    const float* fs = keyPoints.score[ angle.from ].data( );
+    const float* tx = keyPoints.x[ angle.to ].data( );
+    const float* ty = keyPoints.y[ angle.to ].data( );
+    const float* ts = keyPoints.score[ angle.to ].data( );
+
+    for ( size_t i = 0; i < n; ++i ) {
+        const float ux = fx[ i ] - cx[ i ];
+        const float uy = fy[ i ] - cy[ i ];
+        const float vx = tx[ i ] - cx[ i ];
+        const float vy = ty[ i ] - cy[ i ];
+        const float cross = ux * vy - uy * vx;
+        const float dot = ux * vx + uy * vy;
+        const float y = std::abs( cross );
+        const float x = std::abs( dot );
+        const float a = std::min( x, y ) / std::max( std::max( x, y ), std::numeric_limits<float>::min( ) );
+        const float s = a * a;
+        const float p = -0.11643287f + s * ( 0.05265332f - s * 0.01172120f );
+        const float octant = a * ( 0.99997726f + s * ( -0.33262347f + s * ( 0.19354346f + s * p ) ) );
+        const float quadrant = y > x ? halfPi - octant : octant;
+        const float radians = dot < 0.f ? pi - quadrant : quadrant;
+        const bool valid = ( cs[ i ] >= threshold ) & ( fs[ i ] >= threshold ) & ( ts[ i ] >= threshold );
+        out[ i ] = valid ? radians : notANumber;
+    }
+}
+
+template <size_t Joint>
+void MotionEnergyKernel(
+    const KeyPointBatch& current, const KeyPointBatch& previous, float* out, size_t n, float threshold
+)
+{
+    const float* cx = current.x[ Joint ].data( );
+    const float* cy = current.y[ Joint ].data( );
+    const float* cs = current.score[ Joint ].data( );
+    const float* px = previous.x[ Joint ].data( );
+    const float* py = previous.y[ Joint ].data( );
+    const float* ps = previous.score[ Joint ].data( );
+
+    for ( size_t i = 0; i < n; ++i ) {
+        const float dx = cx[ i ] - px[ i ];
+        const float dy = cy[ i ] - py[ i ];
+        out[ i ] += ( ( cs[ i ] >= threshold ) & ( ps[ i ] >= threshold ) ) ? dx * dx + dy * dy : 0.f;
+    }
+}
+
+template <size_t... Bones, size_t... Angles, size_t... Joints>
+void RunKernels(
+    const KeyPointBatch& current,
+    const KeyPointBatch& previous,
+    const BatchView& out,
+    float threshold,
+    std::index_sequence<Bones...>,
+    std::index_sequence<Angles...>,
+    std::index_sequence<Joints...>
+)
+{
+    const size_t n = current.Size( );
+    ( BoneLengthKernel<Bones>( current, out.boneLengths[ Bones ], n, threshold ), ... );
+    ( JointAngleKernel<Angles>( current, out.jointAngles[ Angles ], n, threshold ), ... );
+
+    std::fill_n( out.motionEnergy, n, 0.f );
+    ( MotionEnergyKernel<Joints>( current, previous, out.motionEnergy, n, threshold ), ... );
+
+    // * Persons without a match in the previous frame were gathered with a negative score in joint 0
+    const float* matched = previous.score[ 0 ].data( );
+    for ( size_t i = 0; i < n; ++i )
+        out.motionEnergy[ i ] = ( matched[ i ] < 0.f ) ? notANumber : out.motionEnergy[ i ];
+}
+
+// * Analyzes 'frames' into 'out' starting at person index 'offset'. 'previousFrame' precedes frames.front( ) and
+// * may be null at the start of a recording.
+void AnalyzeFrames(
+    std::span<const std::vector<Detection>> frames,
+    const std::vector<Detection>* previousFrame,
+    AnalyticsBatch& out,
+    size_t offset,
+    const Options& options,
+    KeyPointBatch& current,
+    KeyPointBatch& previous
+)
+{
+    size_t numberOfPersons = 0;
+    for ( const auto& frame : frames )
+        numberOfPersons += frame.size( );
+    current.Resize( numberOfPersons );
+    previous.Resize( numberOfPersons );
+
+    size_t index = 0;
+    for ( const auto& frame : frames ) {
+        for ( const auto& detection : frame ) {
+            Gather( current, index, detection );
+            if ( const Detection* match = MatchPrevious( detection, previousFrame, options.minimumIou ) )
+                Gather( previous, index, *match );
+            else
+                GatherUnmatched( previous, index );
+            ++index;
+        }
+        previousFrame = &frame;
+    }
+
+    RunKernels(
+        current,
+        previous,
+        MakeView( out, offset ),
+        options.confidenceThreshold,
+        std::make_index_sequence<numberOfBones>( ),
+        std::make_index_sequence<numberOfJointAngles>( ),
+        std::make_index_sequence<numberOfJoints>( )
+    );
+}
+
+} // namespace
+
+namespace PoseAnalytics {
+
+void KeyPointBatch::Resize( size_t numberOfPersons )
+{
+    for ( size_t j = 0; j < numberOfJoints; ++j ) {
+        x[ j ].resize( numberOfPersons );
+        y[ j ].resize( numberOfPersons );
+        score[ j ].resize( numberOfPersons );
+    }
+}
+
+void AnalyticsBatch::Resize( size_t numberOfPersons )
+{
+    for ( auto& lengths : boneLengths )
+        lengths.resize( numberOfPersons );
+    for ( auto& angles : jointAngles )
+        angles.resize( numberOfPersons );
+    motionEnergy.resize( numberOfPersons );
+}
+
+AnalyticsBatch AnalyzeRecording( std::span<const std::vector<PoseEstimator::Detection>> frames, const Options& options )
+{
+    AnalyticsBatch result;
+    result.frameOffsets.resize( frames.size( ) + 1 );
+    result.frameOffsets[ 0 ] = 0;
+    for ( size_t f = 0; f < frames.size( ); ++f )
+        result.frameOffsets[ f + 1 ] = result.frameOffsets[ f ] + frames[ f ].size( );
+    result.Resize( result.frameOffsets.back( ) );
+
+    const size_t numberOfBlocks = ( frames.size( ) + framesPerBlock - 1 ) / framesPerBlock;
+    const size_t hardwareThreads = std::max( 1u, std::thread::hardware_concurrency( ) );
+    const size_t numberOfThreads = std::min(
+        options.numberOfThreads > 0 ? static_cast<size_t>( options.numberOfThreads ) : hardwareThreads, numberOfBlocks
+    );
+
+    // * Each worker handles every numberOfThreads:th block; blocks only read the frame preceding them
+    auto worker = [ & ]( size_t firstBlock ) {
+        KeyPointBatch current;
+        KeyPointBatch previous;
+        for ( size_t block = firstBlock; block < numberOfBlocks; block += numberOfThreads ) {
+            const size_t begin = block * framesPerBlock;
+            const size_t end = std::min( begin + framesPerBlock, frames.size( ) );
+            AnalyzeFrames(
+                frames.subspan( begin, end - begin ),
+                begin > 0 ? &frames[ begin - 1 ] : nullptr,
+                result,
+                result.frameOffsets[ begin ],
+                options,
+                current,
+                previous
+            );
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for ( size_t t = 1; t < numberOfThreads; ++t )
+        workers.push_back( std::async( std::launch::async, worker, t ) );
+    if ( numberOfThreads > 0 )
+        worker( 0 );
+    for ( auto& w : workers )
+        w.get( );
+
+    return result;
+}
+
+// ##################################
+
+const AnalyticsBatch& FrameAnalyzer::Analyze( const std::vector<PoseEstimator::Detection>& detections )
+{
+    mResult.frameOffsets.assign( { 0, detections.size( ) } );
+    mResult.Resize( detections.size( ) );
+    AnalyzeFrames(
+        std::span( &detections, 1 ),
+        mPrevious.empty( ) ? nullptr : &mPrevious,
+        mResult,
+        0,
+        mOptions,
+        mCurrentKeyPoints,
+        mPreviousKeyPoints
+    );
+    mPrevious = detections;
+    return mResult;
+}
+
+} // namespace PoseAnalytics
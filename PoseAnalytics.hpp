@@ -0,0 +1,123 @@
+#pragma once
+
+#include "PoseEstimator.hpp"
+
+#include <array>
+#include <span>
+#include <vector>
+
+// * Joint angles, bone lengths and per-person motion energy computed from Detection keypoints. The kernels are
+// * generated at compile time from PoseEstimator::skeleton and operate on structure-of-arrays batches so that the
+// * per-joint loops vectorize; recordings are split across threads by frame.
+namespace PoseAnalytics {
+
+constexpr size_t numberOfJoints = std::tuple_size_v<decltype( PoseEstimator::Detection::keyPoints )>;
+constexpr size_t numberOfBones = PoseEstimator::skeleton.size( );
+
+// * Angle at 'center' between the bones 'center -> from' and 'center -> to'
+struct JointAngle {
+    PoseEstimator::Joint center;
+    PoseEstimator::Joint from;
+    PoseEstimator::Joint to;
+};
+
+namespace Detail {
+
+constexpr size_t CountJointAngles( )
+{
+    size_t count = 0;
+    for ( size_t i = 0; i < PoseEstimator::skeleton.size( ); ++i ) {
+        for ( size_t j = i + 1; j < PoseEstimator::skeleton.size( ); ++j ) {
+            const auto& a = PoseEstimator::skeleton[ i ];
+            const auto& b = PoseEstimator::skeleton[ j ];
+            count += ( a.first == b.first ) + ( a.first == b.second ) + ( a.second == b.first )
+                   + ( a.second == b.second );
+        }
+    }
+    return count;
+}
+
+template <size_t N>
+constexpr std::array<JointAngle, N> MakeJointAngles( )
+{
+    std::array<JointAngle, N> angles{ };
+    size_t count = 0;
+    for ( size_t i = 0; i < PoseEstimator::skeleton.size( ); ++i ) {
+        for ( size_t j = i + 1; j < PoseEstimator::skeleton.size( ); ++j ) {
+            const auto [ a0, a1 ] = PoseEstimator::skeleton[ i ];
+            const auto [ b0, b1 ] = PoseEstimator::skeleton[ j ];
+            if ( a0 == b0 )
+                angles[ count++ ] = { a0, a1, b1 };
+            if ( a0 == b1 )
+                angles[ count++ ] = { a0, a1, b0 };
+            if ( a1 == b0 )
+                angles[ count++ ] = { a1, a0, b1 };
+            if ( a1 == b1 )
+                angles[ count++ ] = { a1, a0, b0 };
+        }
+    }
+    return angles;
+}
+
+} // namespace Detail
+
+// * Every pair of skeleton bones sharing a joint, e.g. { leftElbow, leftShoulder, leftWrist }
+constexpr auto jointAngles = Detail::MakeJointAngles<Detail::CountJointAngles( )>( );
+constexpr size_t numberOfJointAngles = jointAngles.size( );
+
+struct Options {
+    float confidenceThreshold = 0.3f; // * Keypoints below this score yield NaN bones / angles
+    float minimumIou = 0.3f;          // * Minimum box IoU to associate a person with the previous frame
+    int numberOfThreads = 0;          // * 0 means std::thread::hardware_concurrency( )
+};
+
+// * Keypoints of a set of persons in structure-of-arrays layout, x[ joint ][ person ]
+struct KeyPointBatch {
+    std::array<std::vector<float>, numberOfJoints> x;
+    std::array<std::vector<float>, numberOfJoints> y;
+    std::array<std::vector<float>, numberOfJoints> score;
+
+    void Resize( size_t numberOfPersons );
+
+    size_t Size( ) const { return score[ 0 ].size( ); }
+};
+
+// * Analytics for all persons of a sequence of frames in structure-of-arrays layout. The persons of frame 'f'
+// * occupy the indices [ frameOffsets[ f ], frameOffsets[ f + 1 ] ) in every array, in detection order.
+// * Values which cannot be computed (low confidence keypoints, no match in the previous frame) are NaN.
+struct AnalyticsBatch {
+    std::vector<size_t> frameOffsets;
+    std::array<std::vector<float>, numberOfBones> boneLengths;      // * Indexed as PoseEstimator::skeleton
+    std::array<std::vector<float>, numberOfJointAngles> jointAngles; // * Radians, indexed as jointAngles
+    std::vector<float> motionEnergy; // * Sum of squared keypoint displacements since the previous frame
+
+    void Resize( size_t numberOfPersons );
+
+    size_t NumberOfFrames( ) const { return frameOffsets.empty( ) ? 0 : frameOffsets.size( ) - 1; }
+
+    size_t NumberOfPersons( ) const { return motionEnergy.size( ); }
+};
+
+AnalyticsBatch AnalyzeRecording(
+    std::span<const std::vector<PoseEstimator::Detection>> frames, const Options& options = { }
+);
+
+// * Incremental variant for use inside a live or headless pipeline, e.g. from a FrameProcessor. Keeps the
+// * previous frame for motion energy and reuses its buffers between calls.
+class FrameAnalyzer {
+public:
+    FrameAnalyzer( const Options& options = { } ) : mOptions( options ) { }
+
+    const AnalyticsBatch& Analyze( const std::vector<PoseEstimator::Detection>& detections );
+
+    void Reset( ) { mPrevious.clear( ); }
+
+private:
+    Options mOptions;
+    std::vector<PoseEstimator::Detection> mPrevious;
+    KeyPointBatch mCurrentKeyPoints;
+    KeyPointBatch mPreviousKeyPoints;
+    AnalyticsBatch mResult;
+};
+
+} // namespace PoseAnalytics
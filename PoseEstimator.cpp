@@ -1,91 +1,82 @@
 #include "PoseEstimator.hpp"
+#include "Metrics.hpp"
+#include "OpenCvDnnInferenceEngine.hpp"
+#include "OrtInferenceEngine.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <format>
+#include <future>
 
 using namespace Logger;
 
 namespace {
 
-bool InitializeCudaBackend( Ort::SessionOptions& sessionOptions )
+std::string ToString( const std::vector<int64_t>& shape )
 {
-    auto& ortApi = Ort::GetApi( );
-    OrtCUDAProviderOptionsV2* pCudaOptions = nullptr;
-    ortApi.CreateCUDAProviderOptions( &pCudaOptions );
-    std::unique_ptr<OrtCUDAProviderOptionsV2, decltype( ortApi.ReleaseCUDAProviderOptions )> cudaOptions(
-        pCudaOptions, ortApi.ReleaseCUDAProviderOptions
-    );
-    std::vector<const char*> keys{ "device_id", "cudnn_conv_use_max_workspace", "do_copy_in_default_stream" };
-    std::vector<const char*> values{ "0", "0", "1" };
-    ortApi.UpdateCUDAProviderOptions( cudaOptions.get( ), keys.data( ), values.data( ), keys.size( ) );
-    return nullptr == ortApi.SessionOptionsAppendExecutionProvider_CUDA_V2( sessionOptions, cudaOptions.get( ) );
-}
-
-bool InitializeTensorRTBackend( Ort::SessionOptions& sessionOptions, const std::string& engineCachePath )
-{
-    auto& ortApi = Ort::GetApi( );
-    OrtTensorRTProviderOptionsV2* pTrtOptions = nullptr;
-    ortApi.CreateTensorRTProviderOptions( &pTrtOptions );
-    std::unique_ptr<OrtTensorRTProviderOptionsV2, decltype( ortApi.ReleaseTensorRTProviderOptions )> trtOptions(
-        pTrtOptions, ortApi.ReleaseTensorRTProviderOptions
-    );
-    std::vector<const char*> trtKeys{
-        "device_id",
-        "trt_fp16_enable",
-        "trt_dla_enable",
-        "trt_dla_core",
-        "trt_engine_cache_enable",
-        "trt_engine_cache_path" };
-    std::vector<const char*> trtValues{ "0", "1", "0", "1", "1", engineCachePath.c_str( ) };
-    ortApi.UpdateTensorRTProviderOptions( trtOptions.get( ), trtKeys.data( ), trtValues.data( ), trtKeys.size( ) );
-    return nullptr == ortApi.SessionOptionsAppendExecutionProvider_TensorRT_V2( sessionOptions, trtOptions.get( ) );
+    std::string text = "[";
+    for ( size_t i = 0; i < shape.size( ); ++i )
+        text += ( i == 0 ? " " : ", " ) + std::to_string( shape[ i ] );
+    return text + " ]";
 }
 
 } // namespace
 
 bool PoseEstimator::Initialize(
-    const wchar_t* const modelFilePath, RuntimeBackend backend, const std::string& instanceName
+    const std::filesystem::path& modelFilePath, RuntimeBackend backend, const std::string& instanceName
 )
 {
-    mEnv = Ort::Env( OrtLoggingLevel::ORT_LOGGING_LEVEL_WARNING, instanceName.c_str( ) );
-
-    Ort::SessionOptions sessionOptions;
+    std::unique_ptr<InferenceEngine> engine;
     switch ( backend ) {
+    case RuntimeBackend::Cpu:
+        engine = std::make_unique<OrtInferenceEngine>(
+            *mLogger, OrtInferenceEngine::ExecutionProvider::Cpu, instanceName
+        );
+        break;
     case RuntimeBackend::Cuda:
-        if ( !InitializeCudaBackend( sessionOptions ) ) {
-            mLogger->Log( Priority::Error, "Cuda backend could not be initialized" );
-            mInitializedModel = false;
-            return false;
-        }
-        mLogger->Log( Priority::Info, "Cuda backend initialized" );
+        engine = std::make_unique<OrtInferenceEngine>(
+            *mLogger, OrtInferenceEngine::ExecutionProvider::Cuda, instanceName
+        );
         break;
     case RuntimeBackend::TensorRT:
-        if ( !InitializeTensorRTBackend( sessionOptions, "C:\\tmp\\" ) ) {
-            mLogger->Log( Priority::Error, "TensorRT backend could not be initialized" );
-            mInitializedModel = false;
-            return false;
-        }
-        mLogger->Log( Priority::Info, "TensorRT backend initialized" );
+        engine = std::make_unique<OrtInferenceEngine>(
+            *mLogger, OrtInferenceEngine::ExecutionProvider::TensorRT, instanceName
+        );
+        break;
+    case RuntimeBackend::OpenCvDnn:
+        engine = std::make_unique<OpenCvDnnInferenceEngine>( *mLogger, OpenCvDnnInferenceEngine::Target::Cpu );
+        break;
+    case RuntimeBackend::OpenCvDnnFp16:
+        engine = std::make_unique<OpenCvDnnInferenceEngine>( *mLogger, OpenCvDnnInferenceEngine::Target::CpuFp16 );
         break;
     }
+    return Initialize( modelFilePath, std::move( engine ) );
+}
 
-    try {
-        mSession = Ort::Session( mEnv, modelFilePath, sessionOptions );
-        mInitializedModel = true;
-        LoadModelParameters( );
-        if ( !DryRun( ) ) {
-            mLogger->Log( Priority::Error, "DryRun did not complete successfully" );
-            mInitializedModel = false;
-            return mInitializedModel;
-        }
+bool PoseEstimator::Initialize( const std::filesystem::path& modelFilePath, std::unique_ptr<InferenceEngine> engine )
+{
+    mInitializedModel = false;
+    mEngine = std::move( engine );
+    if ( !mEngine || !mEngine->Initialize( modelFilePath ) ) {
+        mLogger->Log( Priority::Error, "Inference engine could not be initialized" );
+        return false;
+    }
+
+    mInputTensorShape = mEngine->GetInputShape( );
+    if ( mInputTensorShape.size( ) != 4 ) {
+        mLogger->Log( Priority::Error, "Model input is expected to be NCHW" );
+        return false;
     }
-    catch ( const std::exception& e ) {
-        mLogger->Log( Priority::Error, e.what( ) );
+
+    mInitializedModel = true;
+    if ( !DryRun( ) ) {
+        mLogger->Log( Priority::Error, "DryRun did not complete successfully" );
         mInitializedModel = false;
         return mInitializedModel;
     }
 
-    mLogger->Log( Priority::Info, "Initialized successfully" );
-    mInitializedModel = true;
+    mLogger->Log( Priority::Info, "Initialized successfully with " + mEngine->Name( ) );
     return mInitializedModel;
 }
 
@@ -93,57 +84,66 @@ bool PoseEstimator::Forward(
     std::vector<Detection>& detections, float* frameData, int frameWidth, int frameHeight, int frameChannels
 )
 {
-    if ( !mInitializedModel ) {
-        mLogger->Log( Priority::Warning, "Running forward propagation on an uninitialized model" );
-        return false;
-    }
+    float* const framesData[] = { frameData };
+    return ForwardFrames(
+        std::span<std::vector<Detection>>( &detections, 1 ), framesData, frameWidth, frameHeight, frameChannels
+    );
+}
 
-    auto inputSize = GetModelInputSize( );
-    if ( ( frameData == nullptr ) || ( frameWidth != inputSize.width ) || ( frameHeight != inputSize.height )
-         || ( frameChannels != inputSize.channels ) ) {
-        mLogger->Log( Priority::Error, "Invalid input frame" );
-        return false;
-    }
+bool PoseEstimator::ForwardBatch(
+    std::vector<std::vector<Detection>>& detections,
+    const std::vector<float*>& framesData,
+    int frameWidth,
+    int frameHeight,
+    int frameChannels
+)
+{
+    detections.resize( framesData.size( ) );
+    if ( framesData.empty( ) )
+        return true;
+    return ForwardFrames( detections, framesData, frameWidth, frameHeight, frameChannels );
+}
 
-    std::vector<float> tempIn( frameData, frameData + ( frameWidth * frameHeight * frameChannels ) );
-    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu( OrtDeviceAllocator, OrtMemTypeDefault );
-    const Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo,
-        frameData,
-        frameWidth * frameHeight * frameChannels,
-        mMp.inputTensorShape.data( ),
-        mMp.inputTensorShape.size( )
-    );
-    try {
-        std::vector<Ort::Value> outputTensors = mSession.Run(
-            Ort::RunOptions{ nullptr },
-            mMp.inputNodeNames.data( ),
-            &inputTensor,
-            mMp.numInputNodes,
-            mMp.outputNodeNames.data( ),
-            mMp.numOutputNodes
+bool PoseEstimator::ForwardParallel(
+    std::vector<std::vector<Detection>>& detections,
+    const std::vector<float*>& framesData,
+    int frameWidth,
+    int frameHeight,
+    int frameChannels,
+    int numberOfWorkers
+)
+{
+    detections.resize( framesData.size( ) );
+    if ( framesData.empty( ) )
+        return true;
+
+    // * Contiguous batches of equal size, which may leave fewer batches than requested workers
+    const size_t requestedWorkers = static_cast<size_t>( std::max( numberOfWorkers, 1 ) );
+    const size_t batchSize = ( framesData.size( ) + requestedWorkers - 1 ) / requestedWorkers;
+    const size_t workers = ( framesData.size( ) + batchSize - 1 ) / batchSize;
+
+    auto worker = [ & ]( size_t index ) {
+        const size_t first = index * batchSize;
+        const size_t count = std::min( batchSize, framesData.size( ) - first );
+        return ForwardFrames(
+            std::span<std::vector<Detection>>( detections ).subspan( first, count ),
+            std::span<float* const>( framesData ).subspan( first, count ),
+            frameWidth,
+            frameHeight,
+            frameChannels
         );
-        auto typeAndShapeInfo = outputTensors.front( ).GetTensorTypeAndShapeInfo( );
-        std::vector<int64_t> shape = typeAndShapeInfo.GetShape( );
-        const float* outputData = outputTensors.front( ).GetTensorData<float>( );
-
-        if ( outputData != nullptr ) {
-            detections.resize( shape.front( ) );
-            memcpy(
-                detections.data( ),
-                outputData,
-                sizeof( float ) * std::accumulate( shape.begin( ), shape.end( ), 1, std::multiplies<float>( ) )
-            );
-        }
-    }
-    catch ( const std::exception& e ) {
-        mLogger->Log( Priority::Error, e.what( ) );
-        return false;
-    }
-    return true;
+    };
+
+    std::vector<std::future<bool>> results;
+    for ( size_t w = 1; w < workers; ++w )
+        results.push_back( std::async( std::launch::async, worker, w ) );
+    bool success = worker( 0 );
+    for ( auto& result : results )
+        success &= result.get( );
+    return success;
 }
 
-float PoseEstimator::Benchmark( int numberOfIterations )
+float PoseEstimator::Benchmark( int numberOfIterations, int batchSize )
 {
     if ( !mInitializedModel ) {
         mLogger->Log( Priority::Warning, "Benchmarking on an uninitialized model" );
@@ -153,51 +153,125 @@ float PoseEstimator::Benchmark( int numberOfIterations )
     const auto inputSize = GetModelInputSize( );
     std::unique_ptr<float[]> dummyImage =
         std::make_unique<float[]>( inputSize.width * inputSize.height * inputSize.channels );
-    std::vector<PoseEstimator::Detection> detections;
+    const std::vector<float*> framesData( std::max( batchSize, 1 ), dummyImage.get( ) );
+    std::vector<std::vector<PoseEstimator::Detection>> detections;
 
     const auto start = std::chrono::high_resolution_clock::now( );
     for ( int i = 0; i < numberOfIterations; ++i ) {
-        Forward( detections, dummyImage.get( ), inputSize.width, inputSize.height, inputSize.channels );
+        ForwardBatch( detections, framesData, inputSize.width, inputSize.height, inputSize.channels );
     }
     const auto end = std::chrono::high_resolution_clock::now( );
-    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>( end - start ).count( );
-    return elapsed / numberOfIterations;
+    const float elapsed = std::chrono::duration<float, std::milli>( end - start ).count( );
+    return elapsed / static_cast<float>( numberOfIterations * framesData.size( ) );
 }
 
 PoseEstimator::InputSize PoseEstimator::GetModelInputSize( ) const
 {
     InputSize size;
-    size.channels = static_cast<int>( mMp.inputTensorShape[ 1 ] );
-    size.width = static_cast<int>( mMp.inputTensorShape[ 2 ] );
-    size.height = static_cast<int>( mMp.inputTensorShape[ 3 ] );
+    size.channels = static_cast<int>( mInputTensorShape[ 1 ] );
+    size.width = static_cast<int>( mInputTensorShape[ 2 ] );
+    size.height = static_cast<int>( mInputTensorShape[ 3 ] );
     return size;
 }
 
 // ##########################################################################################################
 
-bool PoseEstimator::DryRun( )
+bool PoseEstimator::IsValidInput( const float* frameData, int frameWidth, int frameHeight, int frameChannels )
 {
     const auto inputSize = GetModelInputSize( );
-    std::unique_ptr<float[]> dummyImage =
-        std::make_unique<float[]>( inputSize.width * inputSize.height * inputSize.channels );
-    std::vector<Detection> dummyOutput;
-    return Forward( dummyOutput, dummyImage.get( ), inputSize.width, inputSize.height, inputSize.channels );
+    return frameData != nullptr && frameWidth == inputSize.width && frameHeight == inputSize.height
+        && frameChannels == inputSize.channels;
+}
+
+bool PoseEstimator::ToDetections( const InferenceEngine::Tensor& output, std::vector<Detection>& detections )
+{
+    const bool validOutput = output.shape.size( ) == 2 && output.shape[ 0 ] >= 0
+                          && output.shape[ 1 ] == valuesPerDetection
+                          && output.data.size( ) == static_cast<size_t>( output.shape[ 0 ] * valuesPerDetection );
+    if ( !validOutput ) {
+        mLogger->Log(
+            Priority::Error,
+            std::format(
+                "Unexpected model output of shape {} with {} values, expected [ N, {} ]",
+                ToString( output.shape ),
+                output.data.size( ),
+                valuesPerDetection
+            )
+        );
+        return false;
+    }
+    detections.resize( output.shape[ 0 ] );
+    if ( !detections.empty( ) )
+        memcpy( detections.data( ), output.data.data( ), sizeof( float ) * output.data.size( ) );
+    return true;
 }
 
-void PoseEstimator::LoadModelParameters( )
+bool PoseEstimator::ForwardFrames(
+    std::span<std::vector<Detection>> detections,
+    std::span<float* const> framesData,
+    int frameWidth,
+    int frameHeight,
+    int frameChannels
+)
 {
-    Ort::AllocatorWithDefaultOptions allocator;
-    mMp.numInputNodes = mSession.GetInputCount( );
-    for ( size_t idx = 0; idx < mMp.numInputNodes; ++idx ) {
-        mMp.inputNodeNamesAllocated.push_back( mSession.GetInputNameAllocated( idx, allocator ) );
-        mMp.inputNodeNames.push_back( mMp.inputNodeNamesAllocated.back( ).get( ) );
+    if ( !mInitializedModel ) {
+        mLogger->Log( Priority::Warning, "Running forward propagation on an uninitialized model" );
+        return false;
+    }
+
+    for ( const float* frameData : framesData ) {
+        if ( !IsValidInput( frameData, frameWidth, frameHeight, frameChannels ) ) {
+            mLogger->Log( Priority::Error, "Invalid input frame" );
+            Metrics::PipelineMetrics::Get( ).forwardFailures.Increment( );
+            return false;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now( );
+
+    Batch batch = AcquireBatch( );
+    batch.inputs.assign( framesData.begin( ), framesData.end( ) );
+    bool success = mEngine->ForwardBatch( batch.inputs, batch.outputs );
+    if ( success ) {
+        for ( size_t i = 0; i < framesData.size( ); ++i )
+            success &= ToDetections( batch.outputs[ i ], detections[ i ] );
+    }
+    else {
+        mLogger->Log( Priority::Error, "Forward propagation failed on " + mEngine->Name( ) );
     }
+    ReleaseBatch( std::move( batch ) );
 
-    mMp.numOutputNodes = mSession.GetOutputCount( );
-    for ( size_t idx = 0; idx < mMp.numOutputNodes; ++idx ) {
-        mMp.outputNodeNamesAllocated.push_back( mSession.GetOutputNameAllocated( idx, allocator ) );
-        mMp.outputNodeNames.push_back( mMp.outputNodeNamesAllocated.back( ).get( ) );
+    if ( !success ) {
+        Metrics::PipelineMetrics::Get( ).forwardFailures.Increment( );
+        return false;
     }
+    // * One observation per engine call, i.e. per batch
+    const auto end = std::chrono::steady_clock::now( );
+    Metrics::PipelineMetrics::Get( ).forwardLatency.Observe( std::chrono::duration<double>( end - start ).count( ) );
+    return true;
+}
+
+PoseEstimator::Batch PoseEstimator::AcquireBatch( )
+{
+    std::scoped_lock lock( mBatchPoolMutex );
+    if ( mBatchPool.empty( ) )
+        return { };
+    Batch batch = std::move( mBatchPool.back( ) );
+    mBatchPool.pop_back( );
+    return batch;
+}
 
-    mMp.inputTensorShape = mSession.GetInputTypeInfo( 0 ).GetTensorTypeAndShapeInfo( ).GetShape( );
-}
\ No newline at end of file
+void PoseEstimator::ReleaseBatch( Batch&& batch )
+{
+    std::scoped_lock lock( mBatchPoolMutex );
+    mBatchPool.push_back( std::move( batch ) );
+}
+
+bool PoseEstimator::DryRun( )
+{
+    const auto inputSize = GetModelInputSize( );
+    std::unique_ptr<float[]> dummyImage =
+        std::make_unique<float[]>( inputSize.width * inputSize.height * inputSize.channels );
+    std::vector<Detection> dummyOutput;
+    return Forward( dummyOutput, dummyImage.get( ), inputSize.width, inputSize.height, inputSize.channels );
+}
@@ -1,13 +1,15 @@
 #pragma once
 
+#include "InferenceEngine.hpp"
 #include "Logger.hpp"
 
 #include <array>
-#include <numeric>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <vector>
 
-#include <onnxruntime_cxx_api.h>
-
 class PoseEstimator {
 public:
     struct InputSize {
@@ -79,8 +81,6 @@ public:
         JointConnection{ Joint::rightEar, Joint::rightShoulder } };
 
     PoseEstimator( std::unique_ptr<Logger::ILogger> logger ) :
-        mEnv( nullptr ),
-        mSession( nullptr ),
         mInitializedModel( false ),
         mLogger( std::move( logger ) )
     {
@@ -89,40 +89,87 @@ public:
     ~PoseEstimator( ) = default;
 
     enum class RuntimeBackend {
-        Cuda,
-        TensorRT
+        Cpu,          // * onnxruntime, default CPU execution provider
+        Cuda,         // * onnxruntime, CUDA execution provider
+        TensorRT,     // * onnxruntime, TensorRT execution provider
+        OpenCvDnn,    // * cv::dnn, DNN_TARGET_CPU
+        OpenCvDnnFp16 // * cv::dnn, DNN_TARGET_CPU_FP16
     };
     bool Initialize(
-        const wchar_t* const modelFilePath, RuntimeBackend backend, const std::string& instanceName = "Model"
+        const std::filesystem::path& modelFilePath, RuntimeBackend backend, const std::string& instanceName = "Model"
     );
 
+    // * Runs any other InferenceEngine implementation, 'engine' is initialized with 'modelFilePath' here
+    bool Initialize( const std::filesystem::path& modelFilePath, std::unique_ptr<InferenceEngine> engine );
+
     bool Forward(
         std::vector<Detection>& detections, float* frameData, int frameWidth, int frameHeight, int frameChannels
     );
 
-    float Benchmark( int numberOfIterations );
+    // * Runs all frames through InferenceEngine::ForwardBatch, i.e. as one batch on models with a dynamic batch
+    // * dimension. 'detections' is resized to the number of frames.
+    bool ForwardBatch(
+        std::vector<std::vector<Detection>>& detections,
+        const std::vector<float*>& framesData,
+        int frameWidth,
+        int frameHeight,
+        int frameChannels
+    );
+
+    // * Splits the frames into 'numberOfWorkers' contiguous batches run by threads sharing the inference engine.
+    // * Every onnxruntime call already runs on the full intra-op pool, so more workers only pay off with an engine
+    // * limited to a fraction of the cores; the OpenCV DNN engine serializes calls and gains nothing from them.
+    bool ForwardParallel(
+        std::vector<std::vector<Detection>>& detections,
+        const std::vector<float*>& framesData,
+        int frameWidth,
+        int frameHeight,
+        int frameChannels,
+        int numberOfWorkers = 1
+    );
+
+    // * Milliseconds per frame, running 'batchSize' frames per ForwardBatch call
+    float Benchmark( int numberOfIterations, int batchSize = 1 );
 
     InputSize GetModelInputSize( ) const;
 
+    std::string GetEngineName( ) const { return mEngine ? mEngine->Name( ) : "none"; }
+
 private:
-    Ort::Env mEnv;
-    Ort::Session mSession;
+    // * Floats per row of the [ N, 57 ] model output, i.e. box plus 17 keypoints
+    static constexpr int64_t valuesPerDetection = sizeof( Detection ) / sizeof( float );
+    static_assert( valuesPerDetection == 57, "Detection has to match a row of the model output" );
+
     bool mInitializedModel;
+    std::vector<int64_t> mInputTensorShape;
+    std::unique_ptr<Logger::ILogger> mLogger;
+    std::unique_ptr<InferenceEngine> mEngine; // * After mLogger, engines log through it
 
-    struct ModelParameters {
-        size_t numInputNodes;
-        size_t numOutputNodes;
-        std::vector<Ort::AllocatedStringPtr> inputNodeNamesAllocated;
-        std::vector<const char*> inputNodeNames;
-        std::vector<Ort::AllocatedStringPtr> outputNodeNamesAllocated;
-        std::vector<const char*> outputNodeNames;
-        std::vector<int64_t> inputTensorShape;
+    // * Engine inputs and outputs, one per concurrent Forward / ForwardBatch call, reused so that steady state calls
+    // * do not reallocate the outputs
+    struct Batch {
+        std::vector<const float*> inputs;
+        std::vector<InferenceEngine::Tensor> outputs;
     };
-
-    ModelParameters mMp;
-    std::unique_ptr<Logger::ILogger> mLogger;
+    std::mutex mBatchPoolMutex;
+    std::vector<Batch> mBatchPool;
 
     bool DryRun( );
 
-    void LoadModelParameters( );
+    bool IsValidInput( const float* frameData, int frameWidth, int frameHeight, int frameChannels );
+
+    // * Validates one engine output and copies it to 'detections'
+    bool ToDetections( const InferenceEngine::Tensor& output, std::vector<Detection>& detections );
+
+    bool ForwardFrames(
+        std::span<std::vector<Detection>> detections,
+        std::span<float* const> framesData,
+        int frameWidth,
+        int frameHeight,
+        int frameChannels
+    );
+
+    Batch AcquireBatch( );
+
+    void ReleaseBatch( Batch&& batch );
 };
\ No newline at end of file
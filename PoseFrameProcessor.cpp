@@ -0,0 +1,42 @@
+#include "PoseFrameProcessor.hpp"
+
+#include <opencv2/dnn.hpp>
+
+void PoseFrameProcessor::operator( )( const cv::Mat& frame, Result& result )
+{
+    // * The blob keeps its allocation between frames, as do the recycled detections
+    const PoseEstimator::InputSize inputSize = mModel.GetModelInputSize( );
+    cv::dnn::blobFromImage(
+        frame,
+        mInputBlob,
+        0.00392156862745098,
+        cv::Size( inputSize.width, inputSize.height ),
+        cv::Scalar( 0, 0, 0, 0 ),
+        true,
+        false,
+        CV_32F
+    );
+
+    float* const tensor = reinterpret_cast<float*>( mInputBlob.data );
+    if ( !mModel.Forward( result.detections, tensor, inputSize.width, inputSize.height, inputSize.channels ) )
+        result.detections.clear( );
+    else if ( mRecorder != nullptr )
+        mRecorder->Record( tensor, result.detections );
+
+    if ( mAnalyzer != nullptr ) {
+        const auto& motionEnergy = mAnalyzer->Analyze( result.detections ).motionEnergy;
+        result.motionEnergy.assign( motionEnergy.begin( ), motionEnergy.end( ) );
+    }
+
+    result.scaleFactor = {
+        .wFactor = static_cast<float>( frame.cols ) / static_cast<float>( inputSize.width ),
+        .hFactor = static_cast<float>( frame.rows ) / static_cast<float>( inputSize.height ) };
+}
+
+void TiledPoseFrameProcessor::operator( )( const cv::Mat& frame, Result& result )
+{
+    // * Regions, blobs and per region detections are reused from mWorkspace, as are the recycled detections
+    if ( !TiledInference::Forward( mModel, frame, result.detections, mOptions, mWorkspace ) )
+        result.detections.clear( );
+    result.scaleFactor = { .wFactor = 1.f, .hFactor = 1.f };
+}
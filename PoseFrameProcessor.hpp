@@ -0,0 +1,76 @@
+#pragma once
+
+#include "DrawUtils.hpp"
+#include "PoseAnalytics.hpp"
+#include "PoseEstimator.hpp"
+#include "TensorRecording.hpp"
+#include "TiledInference.hpp"
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// * FrameProcessor implementations running pose estimation, see FrameStreamer::Run
+
+struct PoseResult {
+    std::vector<PoseEstimator::Detection> detections;
+    DrawUtils::ScaleFactor scaleFactor{ .wFactor = 1.f, .hFactor = 1.f };
+    std::vector<float> motionEnergy; // * Per detection, in model input pixels. Only filled with an analyzer, NaN if new
+
+    PoseResult( ) = default;
+    PoseResult( PoseResult&& ) noexcept = default;
+    PoseResult& operator=( PoseResult&& ) noexcept = default;
+    PoseResult( const PoseResult& ) = delete;
+    PoseResult& operator=( const PoseResult& ) = delete;
+
+    cv::Mat Overlay( const cv::Size& frameSize, int frameType ) const
+    {
+        return DrawUtils::DrawPosesInFrame( frameSize, frameType, detections, scaleFactor );
+    }
+};
+
+// * Resizes the whole frame to the model input and runs a single forward pass
+class PoseFrameProcessor {
+public:
+    using Result = PoseResult;
+
+    // * When 'recorder' is given, every input tensor is recorded together with its detections. When 'analyzer' is
+    // * given, the motion energy of every detection is computed on the processor thread.
+    explicit PoseFrameProcessor(
+        PoseEstimator& model,
+        TensorRecording::Recorder* recorder = nullptr,
+        PoseAnalytics::FrameAnalyzer* analyzer = nullptr
+    ) :
+        mModel( model ),
+        mRecorder( recorder ),
+        mAnalyzer( analyzer )
+    {
+    }
+
+    void operator( )( const cv::Mat& frame, Result& result );
+
+private:
+    PoseEstimator& mModel;
+    TensorRecording::Recorder* mRecorder;
+    PoseAnalytics::FrameAnalyzer* mAnalyzer;
+    cv::Mat mInputBlob;
+};
+
+// * Splits high resolution frames into overlapping model sized tiles instead of downscaling, see TiledInference
+class TiledPoseFrameProcessor {
+public:
+    using Result = PoseResult;
+
+    TiledPoseFrameProcessor( PoseEstimator& model, const TiledInference::Options& options ) :
+        mModel( model ),
+        mOptions( options )
+    {
+    }
+
+    void operator( )( const cv::Mat& frame, Result& result );
+
+private:
+    PoseEstimator& mModel;
+    const TiledInference::Options mOptions;
+    TiledInference::Workspace mWorkspace;
+};
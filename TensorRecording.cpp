@@ -0,0 +1,217 @@
+#include "TensorRecording.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+using namespace Logger;
+
+namespace {
+
+constexpr char recordingMagic[ 4 ] = { 'Y', 'P', 'T', 'R' };
+constexpr uint32_t recordingVersion = 1;
+
+size_t TensorSize( const PoseEstimator::InputSize& inputSize )
+{
+    return static_cast<size_t>( inputSize.width ) * inputSize.height * inputSize.channels;
+}
+
+// * Largest absolute difference between two detection lists, infinity if the number of detections differ
+float MaxAbsoluteError(
+    std::span<const PoseEstimator::Detection> expected, const std::vector<PoseEstimator::Detection>& actual
+)
+{
+    if ( expected.size( ) != actual.size( ) )
+        return std::numeric_limits<float>::infinity( );
+
+    constexpr size_t valuesPerDetection = sizeof( PoseEstimator::Detection ) / sizeof( float );
+    const float* e = reinterpret_cast<const float*>( expected.data( ) );
+    const float* a = reinterpret_cast<const float*>( actual.data( ) );
+    float maxError = 0.f;
+    for ( size_t i = 0; i < expected.size( ) * valuesPerDetection; ++i ) {
+        const float error = std::abs( e[ i ] - a[ i ] );
+        maxError = std::isnan( error ) ? std::numeric_limits<float>::infinity( ) : std::max( maxError, error );
+    }
+    return maxError;
+}
+
+} // namespace
+
+namespace TensorRecording {
+
+bool Recorder::Open( const std::filesystem::path& recordingFilePath, const PoseEstimator::InputSize& inputSize )
+{
+    std::scoped_lock lock( mMutex );
+    mFile = std::ofstream( recordingFilePath, std::ios::binary | std::ios::trunc );
+    if ( !mFile ) {
+        mLogger->Log( Priority::Error, "Recording file could not be opened: " + recordingFilePath.string( ) );
+        return false;
+    }
+
+    FileHeader header{ };
+    std::memcpy( header.magic, recordingMagic, sizeof( recordingMagic ) );
+    header.version = recordingVersion;
+    header.width = inputSize.width;
+    header.height = inputSize.height;
+    header.channels = inputSize.channels;
+    mFile.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+    mInputSize = inputSize;
+    mNumberOfRecords = 0;
+    return mFile.good( );
+}
+
+bool Recorder::Record( const float* tensor, const std::vector<PoseEstimator::Detection>& detections )
+{
+    std::scoped_lock lock( mMutex );
+    if ( !mFile.is_open( ) || tensor == nullptr )
+        return false;
+
+    const auto now = std::chrono::steady_clock::now( );
+    if ( mNumberOfRecords == 0 )
+        mStart = now;
+
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>( now - mStart );
+    const RecordHeader header{
+        .timestampNs = static_cast<uint64_t>( timestamp.count( ) ),
+        .numberOfDetections = static_cast<uint32_t>( detections.size( ) ),
+        .reserved = 0 };
+    mFile.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+    mFile.write( reinterpret_cast<const char*>( tensor ), TensorSize( mInputSize ) * sizeof( float ) );
+    mFile.write(
+        reinterpret_cast<const char*>( detections.data( ) ), detections.size( ) * sizeof( PoseEstimator::Detection )
+    );
+    if ( !mFile.good( ) ) {
+        mLogger->Log( Priority::Error, "Writing to the recording failed" );
+        return false;
+    }
+    ++mNumberOfRecords;
+    return true;
+}
+
+void Recorder::Close( )
+{
+    std::scoped_lock lock( mMutex );
+    if ( mFile.is_open( ) )
+        mFile.close( );
+}
+
+// ##################################
+
+bool Reader::Open( const std::filesystem::path& recordingFilePath )
+{
+    mRecordOffsets.clear( );
+    mFile = MappedFile( recordingFilePath );
+    if ( !mFile.IsOpen( ) || mFile.Size( ) < sizeof( FileHeader ) )
+        return false;
+
+    std::memcpy( &mHeader, mFile.Data( ), sizeof( mHeader ) );
+    if ( std::memcmp( mHeader.magic, recordingMagic, sizeof( recordingMagic ) ) != 0
+         || mHeader.version != recordingVersion || mHeader.width <= 0 || mHeader.height <= 0 || mHeader.channels <= 0 )
+        return false;
+
+    const size_t tensorBytes = TensorSize( GetInputSize( ) ) * sizeof( float );
+    size_t offset = sizeof( FileHeader );
+    while ( offset + sizeof( RecordHeader ) <= mFile.Size( ) ) {
+        RecordHeader header;
+        std::memcpy( &header, mFile.Data( ) + offset, sizeof( header ) );
+        const size_t recordBytes =
+            sizeof( RecordHeader ) + tensorBytes + header.numberOfDetections * sizeof( PoseEstimator::Detection );
+        if ( offset + recordBytes > mFile.Size( ) )
+            break; // * Truncated trailing record, e.g. from an interrupted run
+        mRecordOffsets.push_back( offset );
+        offset += recordBytes;
+    }
+    return true;
+}
+
+PoseEstimator::InputSize Reader::GetInputSize( ) const
+{
+    return { .width = mHeader.width, .height = mHeader.height, .channels = mHeader.channels };
+}
+
+Record Reader::GetRecord( size_t index ) const
+{
+    const unsigned char* data = mFile.Data( ) + mRecordOffsets[ index ];
+    RecordHeader header;
+    std::memcpy( &header, data, sizeof( header ) );
+    data += sizeof( RecordHeader );
+
+    // * All sections are multiples of 4 bytes from a page aligned mapping, so the casts are properly aligned
+    const float* tensor = reinterpret_cast<const float*>( data );
+    data += TensorSize( GetInputSize( ) ) * sizeof( float );
+    const auto* detections = reinterpret_cast<const PoseEstimator::Detection*>( data );
+    return { .timestamp = std::chrono::nanoseconds( header.timestampNs ),
+             .tensor = tensor,
+             .detections = { detections, header.numberOfDetections } };
+}
+
+// ##################################
+
+bool Replay( PoseEstimator& model, const Reader& reader, const ReplayOptions& options, ReplayReport& report )
+{
+    report = { };
+    const auto inputSize = reader.GetInputSize( );
+    const auto modelInputSize = model.GetModelInputSize( );
+    if ( inputSize.width != modelInputSize.width || inputSize.height != modelInputSize.height
+         || inputSize.channels != modelInputSize.channels ) {
+        report.failure = ReplayReport::Failure::InputShapeMismatch;
+        return false;
+    }
+
+    const size_t batchSize = static_cast<size_t>( std::max( options.batchSize, 1 ) );
+    std::vector<double> forwardMs;
+    forwardMs.reserve( reader.NumberOfRecords( ) * std::max( options.iterations, 1 ) / batchSize + 1 );
+    std::vector<float*> framesData;
+    std::vector<std::vector<PoseEstimator::Detection>> detections;
+
+    const auto replayStart = std::chrono::steady_clock::now( );
+    for ( int iteration = 0; iteration < std::max( options.iterations, 1 ); ++iteration ) {
+        const auto iterationStart = std::chrono::steady_clock::now( );
+        for ( size_t first = 0; first < reader.NumberOfRecords( ); first += batchSize ) {
+            const size_t count = std::min( batchSize, reader.NumberOfRecords( ) - first );
+            // * onnxruntime only reads input tensors, so the read-only mapping can be passed directly
+            framesData.clear( );
+            for ( size_t i = first; i < first + count; ++i )
+                framesData.push_back( const_cast<float*>( reader.GetRecord( i ).tensor ) );
+            // * A batch starts once its last frame would have been captured
+            if ( options.timing == ReplayOptions::Timing::Original )
+                std::this_thread::sleep_until( iterationStart + reader.GetRecord( first + count - 1 ).timestamp );
+
+            const auto start = std::chrono::steady_clock::now( );
+            const bool success =
+                model.ForwardBatch( detections, framesData, inputSize.width, inputSize.height, inputSize.channels );
+            const auto end = std::chrono::steady_clock::now( );
+            if ( !success ) {
+                report.failure = ReplayReport::Failure::ForwardFailed;
+                report.failedRecord = first;
+                return false;
+            }
+            forwardMs.push_back( std::chrono::duration<double, std::milli>( end - start ).count( ) / count );
+
+            for ( size_t i = 0; i < count; ++i ) {
+                const float error = MaxAbsoluteError( reader.GetRecord( first + i ).detections, detections[ i ] );
+                report.maxAbsoluteError = std::max( report.maxAbsoluteError, error );
+                if ( error > options.tolerance ) {
+                    if ( report.mismatchedFrames == 0 )
+                        report.firstMismatchedRecord = first + i;
+                    ++report.mismatchedFrames;
+                }
+                ++report.frames;
+            }
+        }
+    }
+    report.totalSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now( ) - replayStart ).count( );
+
+    if ( !forwardMs.empty( ) ) {
+        std::sort( forwardMs.begin( ), forwardMs.end( ) );
+        report.medianForwardMs = forwardMs[ forwardMs.size( ) / 2 ];
+        report.p95ForwardMs = forwardMs[ ( forwardMs.size( ) * 95 ) / 100 ];
+        report.p99ForwardMs = forwardMs[ ( forwardMs.size( ) * 99 ) / 100 ];
+    }
+    return true;
+}
+
+} // namespace TensorRecording
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Logger.hpp"
+#include "MappedFile.hpp"
+#include "PoseEstimator.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// * Records the exact preprocessed input tensors of a live run together with the resulting detections, and
+// * replays them straight into PoseEstimator::Forward without decode / preprocessing. The recording is read
+// * through a memory mapping so that tensors are passed to the model without copies.
+// *
+// * File layout, little endian:
+// *   FileHeader
+// *   repeated: RecordHeader, float tensor[ width * height * channels ], Detection detections[ numberOfDetections ]
+namespace TensorRecording {
+
+struct FileHeader {
+    char magic[ 4 ];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t channels;
+    uint32_t reserved[ 3 ];
+};
+
+struct RecordHeader {
+    uint64_t timestampNs; // * Since the first record
+    uint32_t numberOfDetections;
+    uint32_t reserved;
+};
+
+static_assert( sizeof( FileHeader ) == 32 && sizeof( RecordHeader ) == 16 );
+
+class Recorder {
+public:
+    Recorder( std::unique_ptr<Logger::ILogger> logger ) : mLogger( std::move( logger ) ), mNumberOfRecords( 0 ) { }
+
+    bool Open( const std::filesystem::path& recordingFilePath, const PoseEstimator::InputSize& inputSize );
+
+    // * Thread safe, 'tensor' holds width * height * channels floats as passed to PoseEstimator::Forward
+    bool Record( const float* tensor, const std::vector<PoseEstimator::Detection>& detections );
+
+    void Close( );
+
+    size_t NumberOfRecords( ) const { return mNumberOfRecords; }
+
+private:
+    std::unique_ptr<Logger::ILogger> mLogger;
+    std::mutex mMutex;
+    std::ofstream mFile;
+    PoseEstimator::InputSize mInputSize{ };
+    std::chrono::steady_clock::time_point mStart;
+    size_t mNumberOfRecords;
+};
+
+struct Record {
+    std::chrono::nanoseconds timestamp;
+    const float* tensor;
+    std::span<const PoseEstimator::Detection> detections;
+};
+
+class Reader {
+public:
+    bool Open( const std::filesystem::path& recordingFilePath );
+
+    PoseEstimator::InputSize GetInputSize( ) const;
+
+    size_t NumberOfRecords( ) const { return mRecordOffsets.size( ); }
+
+    Record GetRecord( size_t index ) const;
+
+private:
+    MappedFile mFile;
+    FileHeader mHeader{ };
+    std::vector<size_t> mRecordOffsets;
+};
+
+// ##################################
+
+struct ReplayOptions {
+    enum class Timing {
+        FullSpeed, // * Back to back, for throughput / latency benchmarks
+        Original   // * Paced by the recorded timestamps
+    };
+    Timing timing = Timing::FullSpeed;
+    float tolerance = 1e-4f; // * Maximum absolute difference per output value, 0 requires bit-exact outputs
+    int iterations = 1;      // * Passes over the recording
+    int batchSize = 1;       // * Records per PoseEstimator::ForwardBatch call
+};
+
+struct ReplayReport {
+    enum class Failure {
+        None,
+        InputShapeMismatch, // * The recorded tensors do not fit the model input
+        ForwardFailed       // * In the batch starting at 'failedRecord'
+    };
+    Failure failure = Failure::None;
+    size_t failedRecord = 0;
+    size_t frames = 0;
+    size_t mismatchedFrames = 0;
+    size_t firstMismatchedRecord = 0;
+    float maxAbsoluteError = 0.f;
+    double medianForwardMs = 0.; // * Per frame, i.e. the time of a batch divided by its size
+    double p95ForwardMs = 0.;
+    double p99ForwardMs = 0.;
+    double totalSeconds = 0.;
+
+    bool Matches( ) const { return mismatchedFrames == 0; }
+};
+
+// * Returns false if the recording does not fit the model or Forward fails, see ReplayReport::failure. Output
+// * mismatches are reported.
+bool Replay( PoseEstimator& model, const Reader& reader, const ReplayOptions& options, ReplayReport& report );
+
+} // namespace TensorRecording
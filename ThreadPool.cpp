@@ -0,0 +1,46 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool( size_t numberOfThreads, std::function<void( )> threadInitializer ) :
+    mStopping( false ),
+    mThreadInitializer( std::move( threadInitializer ) )
+{
+    if ( numberOfThreads == 0 )
+        numberOfThreads = std::max( 1u, std::thread::hardware_concurrency( ) );
+
+    mThreads.reserve( numberOfThreads );
+    for ( size_t i = 0; i < numberOfThreads; ++i )
+        mThreads.emplace_back( &ThreadPool::Work, this );
+}
+
+ThreadPool::~ThreadPool( )
+{
+    {
+        std::scoped_lock lock( mMutex );
+        mStopping = true;
+    }
+    mWakeUp.notify_all( );
+    for ( auto& thread : mThreads )
+        thread.join( );
+}
+
+void ThreadPool::Work( )
+{
+    if ( mThreadInitializer )
+        mThreadInitializer( );
+
+    while ( true ) {
+        std::function<void( )> task;
+        {
+            std::unique_lock lock( mMutex );
+            mWakeUp.wait( lock, [ this ] { return mStopping || !mTasks.empty( ); } );
+            // * Pending tasks are still executed on shutdown so that no future is left without a value
+            if ( mTasks.empty( ) )
+                return;
+            task = std::move( mTasks.front( ) );
+            mTasks.pop( );
+        }
+        task( );
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// * Fixed size pool of worker threads executing submitted tasks in FIFO order
+class ThreadPool {
+public:
+    // * 0 means std::thread::hardware_concurrency( ). 'threadInitializer' runs first on every worker thread, e.g. to
+    // * pin it to a set of CPUs.
+    explicit ThreadPool( size_t numberOfThreads = 0, std::function<void( )> threadInitializer = nullptr );
+
+    ~ThreadPool( );
+
+    ThreadPool( const ThreadPool& ) = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit( F&& f )
+    {
+        using ResultType = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<ResultType( )>>( std::forward<F>( f ) );
+        std::future<ResultType> result = task->get_future( );
+        {
+            std::scoped_lock lock( mMutex );
+            mTasks.emplace( [ task ]( ) { ( *task )( ); } );
+        }
+        mWakeUp.notify_one( );
+        return result;
+    }
+
+    size_t Size( ) const { return mThreads.size( ); }
+
+private:
+    void Work( );
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::queue<std::function<void( )>> mTasks;
+    bool mStopping;
+    const std::function<void( )> mThreadInitializer;
+    std::vector<std::thread> mThreads;
+};
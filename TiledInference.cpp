@@ -0,0 +1,239 @@
+#include "TiledInference.hpp"
+
+#include <algorithm>
+
+#include <opencv2/dnn.hpp>
+
+namespace {
+
+using Detection = PoseEstimator::Detection;
+
+using TiledInference::RegionDetection;
+
+// * Distance in model input pixels within which a box counts as touching the border of its region
+constexpr float seamMargin = 2.f;
+
+struct Transform {
+    float scaleX;
+    float scaleY;
+    float offsetX;
+    float offsetY;
+};
+
+// * Tiles along one axis: every 'tileSize - tileOverlap' pixels while the tile ends inside the frame, plus one
+// * aligned to the frame end
+int NumberOfTiles( int frameLength, int tileSize, int tileOverlap )
+{
+    if ( frameLength <= tileSize )
+        return 1;
+    const int stride = tileSize - tileOverlap;
+    return ( frameLength - tileSize + stride - 1 ) / stride + 1;
+}
+
+int TileOrigin( int index, int frameLength, int tileSize, int tileOverlap )
+{
+    if ( index == NumberOfTiles( frameLength, tileSize, tileOverlap ) - 1 )
+        return std::max( 0, frameLength - tileSize );
+    return index * ( tileSize - tileOverlap );
+}
+
+void AppendTiles( const cv::Size& frameSize, int tileSize, int tileOverlap, std::vector<cv::Rect>& tiles )
+{
+    const int rows = NumberOfTiles( frameSize.height, tileSize, tileOverlap );
+    const int columns = NumberOfTiles( frameSize.width, tileSize, tileOverlap );
+    for ( int row = 0; row < rows; ++row ) {
+        const int y = TileOrigin( row, frameSize.height, tileSize, tileOverlap );
+        for ( int column = 0; column < columns; ++column ) {
+            const int x = TileOrigin( column, frameSize.width, tileSize, tileOverlap );
+            tiles.emplace_back(
+                x, y, std::min( tileSize, frameSize.width - x ), std::min( tileSize, frameSize.height - y )
+            );
+        }
+    }
+}
+
+bool IsValid( int tileSize, int tileOverlap )
+{
+    return tileSize > 0 && tileOverlap >= 0 && tileOverlap < tileSize;
+}
+
+float Area( const PoseEstimator::BoundingBox& box )
+{
+    return ( box.brX - box.tlX ) * ( box.brY - box.tlY );
+}
+
+float Intersection( const PoseEstimator::BoundingBox& a, const PoseEstimator::BoundingBox& b )
+{
+    const float w = std::min( a.brX, b.brX ) - std::max( a.tlX, b.tlX );
+    const float h = std::min( a.brY, b.brY ) - std::max( a.tlY, b.tlY );
+    return ( w <= 0.f || h <= 0.f ) ? 0.f : w * h;
+}
+
+// * Whether 'candidate' duplicates the better detection 'kept'
+bool IsDuplicate(
+    const RegionDetection& kept, const RegionDetection& candidate, float iouThreshold, float containmentThreshold
+)
+{
+    const float intersection = Intersection( kept.detection.box, candidate.detection.box );
+    if ( intersection <= 0.f )
+        return false;
+    const float candidateArea = Area( candidate.detection.box );
+    const float iou = intersection / ( Area( kept.detection.box ) + candidateArea - intersection );
+    if ( iou > iouThreshold )
+        return true;
+    const bool cutOffCopy = candidate.atSeam && candidate.region != kept.region;
+    return cutOffCopy && intersection > containmentThreshold * candidateArea;
+}
+
+// * Whether 'box' touches a border of 'region' which is not a frame border
+bool IsAtSeam(
+    const PoseEstimator::BoundingBox& box,
+    const cv::Rect& region,
+    const cv::Size& frameSize,
+    float marginX,
+    float marginY
+)
+{
+    const int right = region.x + region.width;
+    const int bottom = region.y + region.height;
+    return ( region.x > 0 && box.tlX <= static_cast<float>( region.x ) + marginX )
+        || ( region.y > 0 && box.tlY <= static_cast<float>( region.y ) + marginY )
+        || ( right < frameSize.width && box.brX >= static_cast<float>( right ) - marginX )
+        || ( bottom < frameSize.height && box.brY >= static_cast<float>( bottom ) - marginY );
+}
+
+void ToFrameCoordinates( Detection& detection, const Transform& t )
+{
+    detection.box.tlX = detection.box.tlX * t.scaleX + t.offsetX;
+    detection.box.tlY = detection.box.tlY * t.scaleY + t.offsetY;
+    detection.box.brX = detection.box.brX * t.scaleX + t.offsetX;
+    detection.box.brY = detection.box.brY * t.scaleY + t.offsetY;
+    for ( auto& keyPoint : detection.keyPoints ) {
+        keyPoint.x = keyPoint.x * t.scaleX + t.offsetX;
+        keyPoint.y = keyPoint.y * t.scaleY + t.offsetY;
+    }
+}
+
+} // namespace
+
+namespace TiledInference {
+
+std::vector<cv::Rect> MakeTiles( const cv::Size& frameSize, int tileSize, int tileOverlap )
+{
+    std::vector<cv::Rect> tiles;
+    if ( IsValid( tileSize, tileOverlap ) )
+        AppendTiles( frameSize, tileSize, tileOverlap, tiles );
+    return tiles;
+}
+
+void NonMaximumSuppression( std::vector<RegionDetection>& detections, float iouThreshold, float containmentThreshold )
+{
+    // * On equal scores the larger box goes first, so that a full detection wins over a cut-off copy of itself
+    std::sort( detections.begin( ), detections.end( ), []( const RegionDetection& a, const RegionDetection& b ) {
+        const auto& boxA = a.detection.box;
+        const auto& boxB = b.detection.box;
+        return boxA.score != boxB.score ? boxA.score > boxB.score : Area( boxA ) > Area( boxB );
+    } );
+
+    // * Compacts the kept detections to the front in place, so that the storage of 'detections' is reused
+    size_t numberOfKept = 0;
+    for ( size_t i = 0; i < detections.size( ); ++i ) {
+        const bool suppressed =
+            std::any_of( detections.begin( ), detections.begin( ) + numberOfKept, [ & ]( const RegionDetection& k ) {
+                return IsDuplicate( k, detections[ i ], iouThreshold, containmentThreshold );
+            } );
+        if ( !suppressed )
+            detections[ numberOfKept++ ] = detections[ i ];
+    }
+    detections.resize( numberOfKept );
+}
+
+bool Forward(
+    PoseEstimator& model,
+    const cv::Mat& frame,
+    std::vector<PoseEstimator::Detection>& detections,
+    const Options& options
+)
+{
+    Workspace workspace;
+    return Forward( model, frame, detections, options, workspace );
+}
+
+bool Forward(
+    PoseEstimator& model,
+    const cv::Mat& frame,
+    std::vector<PoseEstimator::Detection>& detections,
+    const Options& options,
+    Workspace& workspace
+)
+{
+    detections.clear( );
+    if ( frame.empty( ) || !IsValid( options.tileSize, options.tileOverlap ) )
+        return false;
+
+    const PoseEstimator::InputSize modelInputSize = model.GetModelInputSize( );
+    const cv::Size modelSize( modelInputSize.width, modelInputSize.height );
+
+    std::vector<cv::Rect>& regions = workspace.regions;
+    regions.clear( );
+    AppendTiles( frame.size( ), options.tileSize, options.tileOverlap, regions );
+    if ( options.coarsePass && regions.size( ) > 1 )
+        regions.emplace_back( 0, 0, frame.cols, frame.rows );
+
+    // * Preprocess every region the same way as the full frame pipeline, blobs keep their allocation between calls
+    workspace.blobs.resize( regions.size( ) );
+    workspace.blobsData.resize( regions.size( ) );
+    for ( size_t i = 0; i < regions.size( ); ++i ) {
+        cv::dnn::blobFromImage(
+            frame( regions[ i ] ),
+            workspace.blobs[ i ],
+            0.00392156862745098,
+            modelSize,
+            cv::Scalar( 0, 0, 0, 0 ),
+            true,
+            false,
+            CV_32F
+        );
+        workspace.blobsData[ i ] = reinterpret_cast<float*>( workspace.blobs[ i ].data );
+    }
+
+    std::vector<std::vector<Detection>>& regionDetections = workspace.regionDetections;
+    const bool success = model.ForwardParallel(
+        regionDetections,
+        workspace.blobsData,
+        modelInputSize.width,
+        modelInputSize.height,
+        modelInputSize.channels,
+        options.numberOfWorkers
+    );
+
+    std::vector<RegionDetection>& candidates = workspace.candidates;
+    candidates.clear( );
+    for ( size_t i = 0; i < regions.size( ); ++i ) {
+        const Transform transform{
+            .scaleX = static_cast<float>( regions[ i ].width ) / static_cast<float>( modelInputSize.width ),
+            .scaleY = static_cast<float>( regions[ i ].height ) / static_cast<float>( modelInputSize.height ),
+            .offsetX = static_cast<float>( regions[ i ].x ),
+            .offsetY = static_cast<float>( regions[ i ].y ) };
+        for ( auto& detection : regionDetections[ i ] ) {
+            if ( detection.box.score < options.confidenceThreshold )
+                continue;
+            ToFrameCoordinates( detection, transform );
+            const bool atSeam = IsAtSeam(
+                detection.box,
+                regions[ i ],
+                frame.size( ),
+                seamMargin * transform.scaleX,
+                seamMargin * transform.scaleY
+            );
+            candidates.push_back( { .detection = detection, .region = static_cast<int>( i ), .atSeam = atSeam } );
+        }
+    }
+
+    NonMaximumSuppression( candidates, options.nmsIouThreshold, options.nmsContainmentThreshold );
+    for ( const auto& candidate : candidates )
+        detections.push_back( candidate.detection );
+    return success;
+}
+
+} // namespace TiledInference
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "PoseEstimator.hpp"
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// * Inference on frames much larger than the model input. The frame is split into overlapping tiles which are
+// * resized to the model input size and run as batches (PoseEstimator::ForwardParallel); detections are translated
+// * back to frame coordinates and duplicates along tile seams are merged with non-maximum suppression.
+namespace TiledInference {
+
+struct Options {
+    int tileSize = 640;                   // * Tile side in frame pixels, each tile is resized to the model input
+    int tileOverlap = 128;                // * Overlap between neighbouring tiles in frame pixels, less than tileSize
+    bool coarsePass = true;               // * Also run the full frame downscaled to the model input, for large persons
+    float confidenceThreshold = 0.3f;     // * Detections below this box score are discarded before merging
+    float nmsIouThreshold = 0.5f;         // * Detections overlapping a better one by more than this are merged
+    float nmsContainmentThreshold = 0.8f; // * As are cut-off ones at a seam with this fraction of their area inside
+    int numberOfWorkers = 1;              // * See PoseEstimator::ForwardParallel
+};
+
+// * Tile regions covering 'frameSize', the last row / column is aligned to the frame border. Empty unless
+// * 0 <= tileOverlap < tileSize.
+std::vector<cv::Rect> MakeTiles( const cv::Size& frameSize, int tileSize, int tileOverlap );
+
+// * A detection together with the region it was found in, for merging across regions
+struct RegionDetection {
+    PoseEstimator::Detection detection;
+    int region;  // * Index of the tile or of the coarse pass region
+    bool atSeam; // * The box touches a border of its region inside the frame, i.e. the person may be cut off
+};
+
+// * Keeps the highest scoring detection of every group overlapping by more than 'iouThreshold'. A detection at a seam
+// * with more than 'containmentThreshold' of its area inside a better one from another region is merged as well, as it
+// * is a cut-off copy of that person; nested detections from the same region are distinct persons and are kept.
+// * Sorted by score, the larger box first on ties.
+void NonMaximumSuppression( std::vector<RegionDetection>& detections, float iouThreshold, float containmentThreshold );
+
+// * Per call buffers, kept by callers running Forward on every frame so that regions, blobs and the per region
+// * detections keep their allocations
+struct Workspace {
+    std::vector<cv::Rect> regions;
+    std::vector<cv::Mat> blobs;
+    std::vector<float*> blobsData;
+    std::vector<std::vector<PoseEstimator::Detection>> regionDetections;
+    std::vector<RegionDetection> candidates;
+};
+
+// * Detections are returned in frame coordinates, i.e. with a scale factor of 1. Returns false on invalid options.
+bool Forward(
+    PoseEstimator& model,
+    const cv::Mat& frame,
+    std::vector<PoseEstimator::Detection>& detections,
+    const Options& options = { }
+);
+
+bool Forward(
+    PoseEstimator& model,
+    const cv::Mat& frame,
+    std::vector<PoseEstimator::Detection>& detections,
+    const Options& options,
+    Workspace& workspace
+);
+
+} // namespace TiledInference
@@ -1,6 +1,12 @@
+#include "CpuAffinity.hpp"
 #include "FrameStreamer.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "PoseAnalytics.hpp"
 #include "PoseEstimator.hpp"
+#include "PoseFrameProcessor.hpp"
+#include "TensorRecording.hpp"
+#include "TiledInference.hpp"
 
 #include <chrono>
 #include <filesystem>
@@ -8,46 +14,59 @@
 #include <memory.h>
 
 #include <opencv2/core.hpp>
-#include <opencv2/dnn.hpp>
 
 int main( )
 {
     std::unique_ptr<Logger::ILogger> logger = std::make_unique<Logger::CoutLogger>( Logger::Priority::Info );
 
+    // * Core partitioning of the pipeline stages, e.g. "decode=0-1;preprocess=2;inference=4-7;render=3". Has to be
+    // * configured before the model is initialized so that the onnxruntime threads are created on the right cores.
+    const std::string cpuLayout = "";
+    CpuAffinity::Layout layout;
+    if ( CpuAffinity::Layout::Parse( cpuLayout, layout ) )
+        CpuAffinity::Partition::Global( ).Configure(
+            layout, std::make_unique<Logger::CoutLogger>( Logger::Priority::Warning )
+        );
+    else
+        logger->Log( Logger::Priority::Warning, "Invalid cpu layout, running unpinned" );
+
     PoseEstimator model( std::move( logger ) );
     const std::string modelFile = "yolov7-w6-pose.onnx"; // "Yolov5s6_pose_640.onnx"; // "yolov7-w6-pose.onnx";
     model.Initialize(
-        std::filesystem::path( __FILE__ ).remove_filename( ).append( modelFile ).wstring( ).c_str( ),
+        std::filesystem::path( __FILE__ ).remove_filename( ).append( modelFile ).c_str( ),
         PoseEstimator::RuntimeBackend::TensorRT,
         "yolo-pose"
     );
 
-    auto RunPoseEstimation = [ &model ]( const cv::Mat& frame ) {
-        // * Preprocess data
-        const PoseEstimator::InputSize modelInputSize = model.GetModelInputSize( );
-        constexpr int batchSize = 1;
-        const int size[] = { batchSize, modelInputSize.channels, modelInputSize.width, modelInputSize.height };
-        cv::Mat inputBlob( 4, size, CV_32F );
-        cv::dnn::blobFromImage(
-            frame,
-            inputBlob,
-            0.00392156862745098,
-            cv::Size( modelInputSize.width, modelInputSize.height ),
-            cv::Scalar( 0, 0, 0, 0 ),
-            true,
-            false,
-            CV_32F
-        );
+    constexpr uint16_t metricsPort = 9464;
+    constexpr bool logMetricsPeriodically = true;
+    Metrics::HttpEndpoint metricsEndpoint(
+        Metrics::Registry::Global( ), std::make_unique<Logger::CoutLogger>( Logger::Priority::Info )
+    );
+    metricsEndpoint.Start( metricsPort );
+    Metrics::PeriodicReporter metricsReporter(
+        std::make_unique<Logger::CoutLogger>( Logger::Priority::Info ), std::chrono::seconds( 5 )
+    );
+    if ( logMetricsPeriodically )
+        metricsReporter.Start( );
+
+    // * Captures the preprocessed tensors and detections for replay with yolo_pose_replay
+    constexpr bool recordTensors = false;
+    const std::string recordingFile = "recording.yptr";
+    TensorRecording::Recorder recorder( std::make_unique<Logger::CoutLogger>( Logger::Priority::Info ) );
+    if ( recordTensors )
+        recorder.Open( recordingFile, model.GetModelInputSize( ) );
+
+    // * Per person motion energy, computed on the processor thread alongside inference
+    constexpr bool analyzePoses = false;
+    PoseAnalytics::FrameAnalyzer analyzer;
 
-        // * Forward propagate
-        std::vector<PoseEstimator::Detection> output;
-        model.Forward( output, ( float* ) inputBlob.data, 640, 640, 3 );
+    PoseFrameProcessor poseProcessor( model, recordTensors ? &recorder : nullptr, analyzePoses ? &analyzer : nullptr );
 
-        return FrameStreamer::Result{
-            output,
-            { .wFactor = static_cast<float>( frame.cols ) / static_cast<float>( modelInputSize.width ),
-              .hFactor = static_cast<float>( frame.rows ) / static_cast<float>( modelInputSize.height ) } };
-    };
+    // * Splits high resolution frames into overlapping model sized tiles instead of downscaling the whole frame
+    const TiledInference::Options tilingOptions{ .tileSize = 640, .tileOverlap = 128, .coarsePass = true };
+    TiledPoseFrameProcessor tiledPoseProcessor( model, tilingOptions );
+    constexpr bool useTiledInference = false;
 
     // const std::string imgFile = "data/img.png";
     // auto fs = CreateFrameStreamer<ImageStreamer>(
@@ -59,15 +78,19 @@ int main( )
         std::filesystem::path( __FILE__ ).remove_filename( ).append( videoFile ).string( )
     );
 
-    if ( fs )
-        fs->Run( RunPoseEstimation );
+    if ( fs ) {
+        if ( useTiledInference )
+            fs->Run( tiledPoseProcessor );
+        else
+            fs->Run( poseProcessor );
+    }
+    std::cout << CpuAffinity::Partition::Global( ).Report( ) << "\n";
 }
 
 // TODO: Fix find path for onnx
-// TODO: Proxy onnxruntime
 // TODO: Implement a CameraStreamer
 // TODO: Add a frame counter in the image
-// TODO: Pimpl to avoid exposing cv::videoio outwards (and ort api from pose estimator)
+// TODO: Pimpl to avoid exposing cv::videoio outwards
 // TODO: Capture if trying to load image to video streamer
 // TODO: Returns silently if cannot find video file
 // TODO: Resize video to specified size
@@ -0,0 +1,172 @@
+#include "CpuAffinity.hpp"
+#include "Logger.hpp"
+#include "PoseEstimator.hpp"
+#include "TensorRecording.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// * Replays a tensor recording made by yolo_pose_cpp into PoseEstimator::Forward and verifies the outputs
+// *   yolo_pose_replay <model.onnx> <recording.yptr> [--backend cpu|cuda|tensorrt|opencv|opencv-fp16]
+// *                    [--original-timing] [--tolerance <value>] [--iterations <n>] [--batch <n>] [--layout <spec>]...
+// * Every --layout runs the replay once more with that core partitioning (see CpuAffinity::Layout::Parse), an empty
+// * spec is the unpinned baseline; the runs are summarized side by side to compare layouts. --batch runs that many
+// * records per PoseEstimator::ForwardBatch call, as one batch on models with a dynamic batch dimension.
+namespace {
+
+void PrintUsage( const char* executable )
+{
+    std::cout << "Usage: " << executable
+              << " <model.onnx> <recording.yptr> [--backend cpu|cuda|tensorrt|opencv|opencv-fp16]"
+                 " [--original-timing] [--tolerance <value>] [--iterations <n>] [--batch <n>] [--layout <spec>]...\n";
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+    if ( argc < 3 ) {
+        PrintUsage( argv[ 0 ] );
+        return 2;
+    }
+
+    const std::filesystem::path modelFilePath( argv[ 1 ] );
+    const std::filesystem::path recordingFilePath( argv[ 2 ] );
+    PoseEstimator::RuntimeBackend backend = PoseEstimator::RuntimeBackend::Cpu;
+    TensorRecording::ReplayOptions options;
+    std::vector<CpuAffinity::Layout> layouts;
+    for ( int i = 3; i < argc; ++i ) {
+        const std::string argument = argv[ i ];
+        if ( argument == "--original-timing" ) {
+            options.timing = TensorRecording::ReplayOptions::Timing::Original;
+        }
+        else if ( argument == "--tolerance" && i + 1 < argc ) {
+            options.tolerance = std::stof( argv[ ++i ] );
+        }
+        else if ( argument == "--iterations" && i + 1 < argc ) {
+            options.iterations = std::stoi( argv[ ++i ] );
+        }
+        else if ( argument == "--batch" && i + 1 < argc ) {
+            options.batchSize = std::stoi( argv[ ++i ] );
+        }
+        else if ( argument == "--backend" && i + 1 < argc ) {
+            const std::string name = argv[ ++i ];
+            if ( name == "cpu" ) {
+                backend = PoseEstimator::RuntimeBackend::Cpu;
+            }
+            else if ( name == "cuda" ) {
+                backend = PoseEstimator::RuntimeBackend::Cuda;
+            }
+            else if ( name == "tensorrt" ) {
+                backend = PoseEstimator::RuntimeBackend::TensorRT;
+            }
+            else if ( name == "opencv" ) {
+                backend = PoseEstimator::RuntimeBackend::OpenCvDnn;
+            }
+            else if ( name == "opencv-fp16" ) {
+                backend = PoseEstimator::RuntimeBackend::OpenCvDnnFp16;
+            }
+            else {
+                std::cout << "Unknown backend: " << name << "\n";
+                PrintUsage( argv[ 0 ] );
+                return 2;
+            }
+        }
+        else if ( argument == "--layout" && i + 1 < argc ) {
+            CpuAffinity::Layout layout;
+            if ( !CpuAffinity::Layout::Parse( argv[ ++i ], layout ) ) {
+                std::cout << "Invalid layout: " << argv[ i ] << "\n";
+                return 2;
+            }
+            layouts.push_back( layout );
+        }
+        else {
+            std::cout << "Unknown argument: " << argument << "\n";
+            PrintUsage( argv[ 0 ] );
+            return 2;
+        }
+    }
+
+    if ( layouts.empty( ) )
+        layouts.push_back( CpuAffinity::Partition::Global( ).GetLayout( ) );
+
+    TensorRecording::Reader reader;
+    if ( !reader.Open( recordingFilePath ) ) {
+        std::cout << "Could not open recording " << recordingFilePath.string( ) << "\n";
+        return 1;
+    }
+
+    std::vector<TensorRecording::ReplayReport> reports;
+    for ( const auto& layout : layouts ) {
+        // * The session has to be created after the layout is configured for its intra-op threads to be pinned, and
+        // * before this thread enters its stage so that threads created by the session do not inherit that stage
+        auto& partition = CpuAffinity::Partition::Global( );
+        partition.Configure( layout, std::make_unique<Logger::CoutLogger>( Logger::Priority::Warning ) );
+
+        PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Warning ) );
+        if ( !model.Initialize( modelFilePath.c_str( ), backend, "yolo-pose-replay" ) )
+            return 1;
+        const CpuAffinity::ScopedStage callerStage( CpuAffinity::Stage::Preprocess );
+
+        TensorRecording::ReplayReport report;
+        if ( !TensorRecording::Replay( model, reader, options, report ) ) {
+            if ( report.failure == TensorRecording::ReplayReport::Failure::InputShapeMismatch ) {
+                const auto recorded = reader.GetInputSize( );
+                const auto expected = model.GetModelInputSize( );
+                std::cout << std::format(
+                    "Replay failed, the recorded tensors ({}x{}x{}) do not match the model input ({}x{}x{})\n",
+                    recorded.channels,
+                    recorded.height,
+                    recorded.width,
+                    expected.channels,
+                    expected.height,
+                    expected.width
+                );
+            }
+            else {
+                std::cout << std::format(
+                    "Replay failed, inference failed on the batch starting at record {}\n", report.failedRecord
+                );
+            }
+            return 1;
+        }
+
+        std::cout << std::format(
+            "frames {}, mismatched {}, max abs error {}, forward per frame median {:.3f} ms, p95 {:.3f} ms, "
+            "p99 {:.3f} ms, {:.1f} fps\n",
+            report.frames,
+            report.mismatchedFrames,
+            report.maxAbsoluteError,
+            report.medianForwardMs,
+            report.p95ForwardMs,
+            report.p99ForwardMs,
+            report.totalSeconds > 0. ? report.frames / report.totalSeconds : 0.
+        );
+        if ( !report.Matches( ) )
+            std::cout << std::format( "first mismatch at record {}\n", report.firstMismatchedRecord );
+        if ( layout.IsPinned( ) || layouts.size( ) > 1 )
+            std::cout << partition.Report( ) << "\n";
+        reports.push_back( report );
+    }
+
+    if ( layouts.size( ) > 1 ) {
+        std::cout << std::format( "\n{:<48} {:>10} {:>10} {:>10}\n", "layout", "median ms", "p95 ms", "p99 ms" );
+        for ( size_t i = 0; i < layouts.size( ); ++i ) {
+            std::cout << std::format(
+                "{:<48} {:>10.3f} {:>10.3f} {:>10.3f}\n",
+                layouts[ i ].name,
+                reports[ i ].medianForwardMs,
+                reports[ i ].p95ForwardMs,
+                reports[ i ].p99ForwardMs
+            );
+        }
+    }
+
+    const bool matches =
+        std::all_of( reports.begin( ), reports.end( ), []( const auto& report ) { return report.Matches( ); } );
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <opencv2/core.hpp>
+
+namespace {
+
+std::atomic<size_t> gNewCalls = 0;
+std::atomic<size_t> gMatAllocations = 0;
+
+class CountingMatAllocator final : public cv::MatAllocator {
+public:
+    CountingMatAllocator( ) : mAllocator( cv::Mat::getStdAllocator( ) ) { }
+
+    cv::UMatData* allocate(
+        int dims,
+        const int* sizes,
+        int type,
+        void* data,
+        size_t* step,
+        cv::AccessFlag flags,
+        cv::UMatUsageFlags usageFlags
+    ) const override
+    {
+        if ( data == nullptr )
+            gMatAllocations.fetch_add( 1, std::memory_order_relaxed );
+        return mAllocator->allocate( dims, sizes, type, data, step, flags, usageFlags );
+    }
+
+    bool allocate( cv::UMatData* data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags ) const override
+    {
+        return mAllocator->allocate( data, accessflags, usageFlags );
+    }
+
+    void deallocate( cv::UMatData* data ) const override { mAllocator->deallocate( data ); }
+
+private:
+    cv::MatAllocator* mAllocator;
+};
+
+void* CountedAllocate( std::size_t size )
+{
+    gNewCalls.fetch_add( 1, std::memory_order_relaxed );
+    if ( void* p = std::malloc( size ? size : 1 ) )
+        return p;
+    throw std::bad_alloc( );
+}
+
+} // namespace
+
+void* operator new( std::size_t size )
+{
+    return CountedAllocate( size );
+}
+
+void* operator new[]( std::size_t size )
+{
+    return CountedAllocate( size );
+}
+
+void operator delete( void* p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete[]( void* p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void* p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete[]( void* p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+namespace AllocationCounter {
+
+Counts Current( )
+{
+    return { .newCalls = gNewCalls.load( std::memory_order_relaxed ),
+             .matAllocations = gMatAllocations.load( std::memory_order_relaxed ) };
+}
+
+void InstallMatAllocator( )
+{
+    static CountingMatAllocator allocator;
+    cv::Mat::setDefaultAllocator( &allocator );
+}
+
+Scope::Scope( ) : mStart( Current( ) ) { }
+
+Counts Scope::Elapsed( ) const
+{
+    const Counts now = Current( );
+    return { .newCalls = now.newCalls - mStart.newCalls, .matAllocations = now.matAllocations - mStart.matAllocations };
+}
+
+} // namespace AllocationCounter
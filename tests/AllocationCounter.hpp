@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// * Counts heap allocations made through the global operator new and through cv::Mat so that tests can put
+// * budgets on hot paths. The counters are process wide; the global operator new replacement lives in
+// * AllocationCounter.cpp and is linked into the test executable only.
+namespace AllocationCounter {
+
+struct Counts {
+    size_t newCalls;
+    size_t matAllocations;
+};
+
+Counts Current( );
+
+// * Installs a counting cv::MatAllocator as the default allocator, idempotent
+void InstallMatAllocator( );
+
+class Scope {
+public:
+    Scope( );
+
+    Counts Elapsed( ) const;
+
+private:
+    Counts mStart;
+};
+
+} // namespace AllocationCounter
@@ -0,0 +1,244 @@
+#include "SyntheticData.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/videoio.hpp>
+
+namespace {
+
+// * Minimal protobuf wire format writer, just enough to serialize an onnx ModelProto without depending on
+// * protobuf or the onnx python package.
+class ProtoWriter {
+public:
+    void Varint( int field, uint64_t value )
+    {
+        Tag( field, 0 );
+        WriteVarint( value );
+    }
+
+    void Bytes( int field, std::string_view data )
+    {
+        Tag( field, 2 );
+        WriteVarint( data.size( ) );
+        mBuffer.append( data );
+    }
+
+    void Message( int field, const ProtoWriter& message ) { Bytes( field, message.mBuffer ); }
+
+    const std::string& Data( ) const { return mBuffer; }
+
+private:
+    void Tag( int field, int wireType ) { WriteVarint( ( static_cast<uint64_t>( field ) << 3 ) | wireType ); }
+
+    void WriteVarint( uint64_t value )
+    {
+        while ( value >= 0x80 ) {
+            mBuffer.push_back( static_cast<char>( ( value & 0x7F ) | 0x80 ) );
+            value >>= 7;
+        }
+        mBuffer.push_back( static_cast<char>( value ) );
+    }
+
+    std::string mBuffer;
+};
+
+// * Field numbers and enums from onnx.proto
+constexpr int onnxFloat = 1;
+constexpr int onnxInt64 = 7;
+constexpr int onnxAttributeInt = 2;
+constexpr int onnxAttributeInts = 7;
+constexpr int onnxIrVersion = 7;
+constexpr int onnxOpsetVersion = 13;
+
+ProtoWriter MakeValueInfo( std::string_view name, const std::vector<int64_t>& dims )
+{
+    ProtoWriter shape;
+    for ( const auto dimValue : dims ) {
+        ProtoWriter dim;
+        if ( dimValue < 0 )
+            dim.Bytes( 2, "batch" ); // * TensorShapeProto.Dimension.dim_param
+        else
+            dim.Varint( 1, dimValue ); // * TensorShapeProto.Dimension.dim_value
+        shape.Message( 1, dim );       // * TensorShapeProto.dim
+    }
+
+    ProtoWriter tensorType;
+    tensorType.Varint( 1, onnxFloat ); // * TypeProto.Tensor.elem_type
+    tensorType.Message( 2, shape );    // * TypeProto.Tensor.shape
+
+    ProtoWriter type;
+    type.Message( 1, tensorType ); // * TypeProto.tensor_type
+
+    ProtoWriter valueInfo;
+    valueInfo.Bytes( 1, name );   // * ValueInfoProto.name
+    valueInfo.Message( 2, type ); // * ValueInfoProto.type
+    return valueInfo;
+}
+
+ProtoWriter MakeNode(
+    std::string_view opType,
+    const std::vector<std::string_view>& inputs,
+    std::string_view output,
+    const ProtoWriter* attribute = nullptr
+)
+{
+    ProtoWriter node;
+    for ( const auto input : inputs )
+        node.Bytes( 1, input ); // * NodeProto.input
+    node.Bytes( 2, output );    // * NodeProto.output
+    node.Bytes( 3, output );    // * NodeProto.name
+    node.Bytes( 4, opType );    // * NodeProto.op_type
+    if ( attribute )
+        node.Message( 5, *attribute ); // * NodeProto.attribute
+    return node;
+}
+
+} // namespace
+
+namespace SyntheticData {
+
+std::vector<PoseEstimator::Detection> MakeDetections( int count, int inputSize )
+{
+    std::vector<PoseEstimator::Detection> detections( count );
+    const float boxSize = inputSize / 4.f;
+    for ( int i = 0; i < count; ++i ) {
+        auto& detection = detections[ i ];
+        const float tlX = ( i % 3 ) * boxSize;
+        const float tlY = ( i / 3 ) * boxSize;
+        detection.box = {
+            .tlX = tlX,
+            .tlY = tlY,
+            .brX = tlX + boxSize,
+            .brY = tlY + boxSize,
+            .score = 0.9f - 0.1f * i,
+            .label = 0.f };
+
+        for ( int k = 0; k < static_cast<int>( detection.keyPoints.size( ) ); ++k ) {
+            detection.keyPoints[ k ] = {
+                .x = tlX + boxSize * ( 0.1f + 0.05f * k ),
+                .y = tlY + boxSize * ( 0.9f - 0.05f * k ),
+                .score = ( k % 5 == 4 ) ? 0.1f : 0.95f };
+        }
+    }
+    return detections;
+}
+
+bool WriteModel(
+    const std::filesystem::path& modelFilePath,
+    const std::vector<PoseEstimator::Detection>& anchors,
+    int inputSize,
+    bool dynamicBatch
+)
+{
+    constexpr int64_t valuesPerDetection = sizeof( PoseEstimator::Detection ) / sizeof( float );
+    static_assert( valuesPerDetection == 57 );
+
+    ProtoWriter initializer;
+    initializer.Varint( 1, anchors.size( ) ); // * TensorProto.dims
+    initializer.Varint( 1, valuesPerDetection );
+    initializer.Varint( 2, onnxFloat ); // * TensorProto.data_type
+    initializer.Bytes( 8, "anchors" );  // * TensorProto.name
+    initializer.Bytes(
+        9, // * TensorProto.raw_data, little endian
+        std::string_view( reinterpret_cast<const char*>( anchors.data( ) ), anchors.size( ) * sizeof( anchors[ 0 ] ) )
+    );
+
+    ProtoWriter graph;
+    std::vector<int64_t> outputDims{ static_cast<int64_t>( anchors.size( ) ), valuesPerDetection };
+    if ( dynamicBatch ) {
+        // * The mean is taken per image: 'images' is reshaped to [ B, 1, 3 * S * S ] and reduced to [ B, 1, 1 ],
+        // * which broadcasts against the anchors to [ B, N, 57 ]
+        const int64_t perImage[] = { 0, 1, -1 }; // * 0 keeps the batch dimension
+        ProtoWriter shape;
+        shape.Varint( 1, 3 );             // * TensorProto.dims
+        shape.Varint( 2, onnxInt64 );     // * TensorProto.data_type
+        shape.Bytes( 8, "per_image" );    // * TensorProto.name
+        shape.Bytes( 9, std::string_view( reinterpret_cast<const char*>( perImage ), sizeof( perImage ) ) );
+
+        ProtoWriter axes;
+        axes.Bytes( 1, "axes" );               // * AttributeProto.name
+        axes.Varint( 8, 2 );                   // * AttributeProto.ints
+        axes.Varint( 20, onnxAttributeInts ); // * AttributeProto.type
+
+        graph.Message( 1, MakeNode( "Reshape", { "images", "per_image" }, "flat" ) ); // * GraphProto.node
+        graph.Message( 1, MakeNode( "ReduceMean", { "flat" }, "mean", &axes ) );
+        graph.Message( 5, shape ); // * GraphProto.initializer
+        outputDims.insert( outputDims.begin( ), -1 );
+    }
+    else {
+        ProtoWriter keepDims;
+        keepDims.Bytes( 1, "keepdims" );         // * AttributeProto.name
+        keepDims.Varint( 3, 0 );                 // * AttributeProto.i
+        keepDims.Varint( 20, onnxAttributeInt ); // * AttributeProto.type
+        graph.Message( 1, MakeNode( "ReduceMean", { "images" }, "mean", &keepDims ) ); // * GraphProto.node
+    }
+    graph.Message( 1, MakeNode( "Add", { "anchors", "mean" }, "output" ) );
+    graph.Bytes( 2, "synthetic-yolo-pose" ); // * GraphProto.name
+    graph.Message( 5, initializer );         // * GraphProto.initializer
+    graph.Message( 11, MakeValueInfo( "images", { dynamicBatch ? -1 : 1, 3, inputSize, inputSize } ) );
+    graph.Message( 12, MakeValueInfo( "output", outputDims ) ); // * GraphProto.output
+
+    ProtoWriter opset;
+    opset.Varint( 2, onnxOpsetVersion ); // * OperatorSetIdProto.version
+
+    ProtoWriter model;
+    model.Varint( 1, onnxIrVersion );        // * ModelProto.ir_version
+    model.Bytes( 2, "yolo_pose_cpp_tests" ); // * ModelProto.producer_name
+    model.Message( 7, graph );               // * ModelProto.graph
+    model.Message( 8, opset );               // * ModelProto.opset_import
+
+    std::ofstream file( modelFilePath, std::ios::binary | std::ios::trunc );
+    file.write( model.Data( ).data( ), model.Data( ).size( ) );
+    return file.good( );
+}
+
+int FrameLevel( int frameIndex )
+{
+    return 20 + 20 * ( frameIndex % 11 );
+}
+
+bool WriteVideo( const std::filesystem::path& videoFilePath, const cv::Size& frameSize, int numberOfFrames, double fps )
+{
+    // * The built-in MJPEG writer does not depend on ffmpeg / gstreamer being available
+    cv::VideoWriter writer(
+        videoFilePath.string( ), cv::CAP_OPENCV_MJPEG, cv::VideoWriter::fourcc( 'M', 'J', 'P', 'G' ), fps, frameSize
+    );
+    if ( !writer.isOpened( ) )
+        return false;
+
+    for ( int i = 0; i < numberOfFrames; ++i ) {
+        writer << cv::Mat( frameSize, CV_8UC3, cv::Scalar::all( FrameLevel( i ) ) );
+    }
+    return true;
+}
+
+bool WriteImage( const std::filesystem::path& imageFilePath, const cv::Size& frameSize, int level )
+{
+    return cv::imwrite( imageFilePath.string( ), cv::Mat( frameSize, CV_8UC3, cv::Scalar::all( level ) ) );
+}
+
+// ##################################
+
+TemporaryDirectory::TemporaryDirectory( )
+{
+    static std::atomic<int> counter = 0;
+    std::random_device rd;
+    mPath = std::filesystem::temp_directory_path( )
+        / ( "yolo_pose_cpp_tests_" + std::to_string( rd( ) ) + "_" + std::to_string( counter++ ) );
+    std::filesystem::create_directories( mPath );
+}
+
+TemporaryDirectory::~TemporaryDirectory( )
+{
+    std::error_code ec;
+    std::filesystem::remove_all( mPath, ec );
+}
+
+} // namespace SyntheticData
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "PoseEstimator.hpp"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// * Deterministic stand-ins for the yolo-pose weights and input media so that the test suite can run on a
+// * plain CPU-only machine without downloading anything.
+namespace SyntheticData {
+
+constexpr int modelInputSize = 64;
+constexpr int numberOfDetections = 4;
+
+// * The synthetic model computes 'output = anchors + mean( images )', where 'images' is the [1, 3, S, S] input
+// * tensor and 'anchors' is a constant [N, 57] tensor holding the detections below. An all-zero input therefore
+// * yields exactly MakeDetections( ), which keeps the output contract identical to the exported yolo-pose models.
+std::vector<PoseEstimator::Detection> MakeDetections(
+    int count = numberOfDetections, int inputSize = modelInputSize
+);
+
+// * With 'dynamicBatch' the input is [batch, 3, S, S] with a symbolic batch and the output [batch, N, 57], holding
+// * 'anchors + mean( image )' for every image of the batch.
+bool WriteModel(
+    const std::filesystem::path& modelFilePath,
+    const std::vector<PoseEstimator::Detection>& anchors,
+    int inputSize = modelInputSize,
+    bool dynamicBatch = false
+);
+
+// * Returns 'output' for every input of shape [ 1, 3, inputSize, inputSize ], to exercise PoseEstimator with
+// * arbitrary output shapes or without any engine allocations
+class FixedOutputEngine final : public InferenceEngine {
+public:
+    explicit FixedOutputEngine( Tensor output, int inputSize = modelInputSize )
+        : mOutput( std::move( output ) ), mInputSize( inputSize )
+    {
+    }
+
+    bool Initialize( const std::filesystem::path& ) override { return true; }
+
+    std::vector<int64_t> GetInputShape( ) const override { return { 1, 3, mInputSize, mInputSize }; }
+
+    bool Forward( const float*, Tensor& output ) override
+    {
+        output = mOutput;
+        return true;
+    }
+
+    std::string Name( ) const override { return "fixed-output"; }
+
+    Tensor mOutput;
+
+private:
+    const int64_t mInputSize;
+};
+
+// * Every frame is filled with a uniform gray level of 'FrameLevel( frameIndex )' so that frames can be
+// * identified after a lossy encode / decode round trip.
+int FrameLevel( int frameIndex );
+
+bool WriteVideo(
+    const std::filesystem::path& videoFilePath, const cv::Size& frameSize, int numberOfFrames, double fps
+);
+
+bool WriteImage( const std::filesystem::path& imageFilePath, const cv::Size& frameSize, int level );
+
+// * Unique scratch directory below the system temp directory, removed on destruction.
+class TemporaryDirectory {
+public:
+    TemporaryDirectory( );
+
+    ~TemporaryDirectory( );
+
+    TemporaryDirectory( const TemporaryDirectory& ) = delete;
+    TemporaryDirectory& operator=( const TemporaryDirectory& ) = delete;
+
+    const std::filesystem::path& Path( ) const { return mPath; }
+
+private:
+    std::filesystem::path mPath;
+};
+
+} // namespace SyntheticData
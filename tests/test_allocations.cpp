@@ -0,0 +1,181 @@
+#include "AllocationCounter.hpp"
+#include "DrawUtils.hpp"
+#include "FrameStreamer.hpp"
+#include "OrtInferenceEngine.hpp"
+#include "PoseEstimator.hpp"
+#include "PoseFrameProcessor.hpp"
+#include "SyntheticData.hpp"
+#include "TiledInference.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <opencv2/dnn.hpp>
+
+// * Allocation budgets for the hot paths. Unlike the latency budgets in test_performance.cpp these are
+// * deterministic and part of the default test set.
+
+class AllocationTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        AllocationCounter::InstallMatAllocator( );
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, SyntheticData::MakeDetections( ) ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+};
+
+TEST_F( AllocationTest, ForwardAllocationBudget )
+{
+    // * PoseEstimator::Forward may not allocate on top of the engine it wraps, e.g. by copying the input tensor. The
+    // * engine count itself (onnxruntime internals through the global operator new) is measured on a bare
+    // * OrtInferenceEngine running the same model, so that the budget tracks the onnxruntime version in use.
+    const int size = SyntheticData::modelInputSize;
+    std::vector<float> input( 3 * size * size, 0.f );
+
+    Logger::CoutLogger logger( Logger::Priority::Error );
+    OrtInferenceEngine engine( logger, OrtInferenceEngine::ExecutionProvider::Cpu, "baseline" );
+    ASSERT_TRUE( engine.Initialize( sModelFilePath ) );
+    InferenceEngine::Tensor output;
+    ASSERT_TRUE( engine.Forward( input.data( ), output ) );
+    const AllocationCounter::Scope engineScope;
+    ASSERT_TRUE( engine.Forward( input.data( ), output ) );
+    const auto engineAllocations = engineScope.Elapsed( );
+
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( sModelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( model.Forward( detections, input.data( ), size, size, 3 ) );
+
+    const AllocationCounter::Scope scope;
+    ASSERT_TRUE( model.Forward( detections, input.data( ), size, size, 3 ) );
+    const auto allocations = scope.Elapsed( );
+    RecordProperty( "Engine_Forward_new_calls", std::to_string( engineAllocations.newCalls ) );
+    RecordProperty( "Forward_new_calls", std::to_string( allocations.newCalls ) );
+
+    EXPECT_LE( allocations.newCalls, engineAllocations.newCalls );
+    EXPECT_EQ( allocations.matAllocations, 0u );
+}
+
+TEST_F( AllocationTest, DrawPosesInFrameAllocationBudget )
+{
+    constexpr size_t newCallsBudget = 32;
+
+    const auto detections = SyntheticData::MakeDetections( 10, 640 );
+    const DrawUtils::ScaleFactor scaleFactor{ .wFactor = 3.f, .hFactor = 1.6875f };
+
+    const AllocationCounter::Scope scope;
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 1920, 1080 }, CV_8UC3, detections, scaleFactor );
+    const auto allocations = scope.Elapsed( );
+
+    EXPECT_LE( allocations.newCalls, newCallsBudget );
+    EXPECT_EQ( allocations.matAllocations, 1u ); // * The overlay itself
+}
+
+TEST_F( AllocationTest, AsyncFrameProcessorAllocationBudget )
+{
+    // * Steady state hand-off of frames and recycled results between the display loop and the processor thread
+    struct FixedPoseProcessor {
+        using Result = PoseResult;
+
+        void operator( )( const cv::Mat&, Result& result )
+        {
+            result.detections.assign( detections.begin( ), detections.end( ) );
+        }
+
+        const std::vector<PoseEstimator::Detection> detections = SyntheticData::MakeDetections( 10, 640 );
+    };
+
+    FixedPoseProcessor fixedPoseProcessor;
+    AsyncFrameProcessor<FixedPoseProcessor> processor( fixedPoseProcessor );
+    const cv::Mat frame( 1080, 1920, CV_8UC3, cv::Scalar::all( 0 ) );
+    PoseResult result;
+    auto RoundTrip = [ & ]( ) {
+        ASSERT_TRUE( processor.Submit( frame ) );
+        while ( !processor.TryCollect( result ) )
+            std::this_thread::yield( );
+    };
+    for ( int i = 0; i < 3; ++i )
+        RoundTrip( );
+
+    const AllocationCounter::Scope scope;
+    for ( int i = 0; i < 10; ++i )
+        RoundTrip( );
+    const auto allocations = scope.Elapsed( );
+    RecordProperty( "AsyncFrameProcessor_new_calls", std::to_string( allocations.newCalls ) );
+
+    EXPECT_EQ( allocations.newCalls, 0u );
+    EXPECT_EQ( allocations.matAllocations, 0u );
+    EXPECT_EQ( result.detections.size( ), 10u );
+}
+
+TEST_F( AllocationTest, PoseFrameProcessorsAllocateOnlyInPreprocessing )
+{
+    // * With an engine returning a fixed output into the pooled tensor, what is left per frame is the preprocessing
+    // * in cv::dnn::blobFromImage, which is measured on its own for one region
+    const int size = SyntheticData::modelInputSize;
+    const auto anchors = SyntheticData::MakeDetections( );
+    const float* const anchorsData = reinterpret_cast<const float*>( anchors.data( ) );
+    const InferenceEngine::Tensor output{
+        { static_cast<int64_t>( anchors.size( ) ), 57 },
+        std::vector<float>( anchorsData, anchorsData + anchors.size( ) * 57 ) };
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( { }, std::make_unique<SyntheticData::FixedOutputEngine>( output ) ) );
+
+    // * Tiles and the full frame are both resized to the model input
+    const cv::Mat frame( 4 * size, 6 * size, CV_8UC3, cv::Scalar::all( 0 ) );
+    const TiledInference::Options options{ .tileSize = 2 * size, .tileOverlap = size / 2, .numberOfWorkers = 1 };
+    const auto tiles = TiledInference::MakeTiles( frame.size( ), options.tileSize, options.tileOverlap );
+    const size_t numberOfRegions = tiles.size( ) + 1; // * Plus the coarse pass
+
+    cv::Mat blob;
+    auto Preprocess = [ & ]( ) {
+        cv::dnn::blobFromImage(
+            frame( cv::Rect( 0, 0, 2 * size, 2 * size ) ),
+            blob,
+            0.00392156862745098,
+            cv::Size( size, size ),
+            cv::Scalar( 0, 0, 0, 0 ),
+            true,
+            false,
+            CV_32F
+        );
+    };
+    Preprocess( );
+    const AllocationCounter::Scope blobScope;
+    Preprocess( );
+    const auto blobAllocations = blobScope.Elapsed( );
+
+    PoseFrameProcessor processor( model );
+    TiledPoseFrameProcessor tiledProcessor( model, options );
+    PoseResult result;
+    for ( int i = 0; i < 2; ++i ) {
+        processor( frame, result );
+        tiledProcessor( frame, result );
+    }
+
+    const AllocationCounter::Scope scope;
+    processor( frame, result );
+    const auto allocations = scope.Elapsed( );
+    EXPECT_EQ( result.detections.size( ), anchors.size( ) );
+
+    const AllocationCounter::Scope tiledScope;
+    tiledProcessor( frame, result );
+    const auto tiledAllocations = tiledScope.Elapsed( );
+    EXPECT_FALSE( result.detections.empty( ) );
+    RecordProperty( "blobFromImage_new_calls", std::to_string( blobAllocations.newCalls ) );
+    RecordProperty( "TiledPoseFrameProcessor_new_calls", std::to_string( tiledAllocations.newCalls ) );
+
+    EXPECT_LE( allocations.newCalls, blobAllocations.newCalls );
+    EXPECT_LE( allocations.matAllocations, blobAllocations.matAllocations );
+    EXPECT_LE( tiledAllocations.newCalls, numberOfRegions * blobAllocations.newCalls );
+    EXPECT_LE( tiledAllocations.matAllocations, numberOfRegions * blobAllocations.matAllocations );
+}
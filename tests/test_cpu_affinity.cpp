@@ -0,0 +1,167 @@
+#include "CpuAffinity.hpp"
+#include "ThreadPool.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace CpuAffinity;
+
+namespace {
+
+std::unique_ptr<Logger::ILogger> MakeLogger( )
+{
+    return std::make_unique<Logger::CoutLogger>( Logger::Priority::Warning );
+}
+
+bool CanPin( )
+{
+    CpuSet cpus;
+    return GetCurrentThreadAffinity( cpus ) && !cpus.empty( );
+}
+
+} // namespace
+
+TEST( CpuAffinityTest, ParsesCpuSets )
+{
+    CpuSet cpus;
+    ASSERT_TRUE( ParseCpuSet( "3, 0-1,1,7-9", cpus ) );
+    EXPECT_EQ( cpus, ( CpuSet{ 0, 1, 3, 7, 8, 9 } ) );
+    EXPECT_EQ( ToString( cpus ), "0-1,3,7-9" );
+
+    ASSERT_TRUE( ParseCpuSet( "", cpus ) );
+    EXPECT_TRUE( cpus.empty( ) );
+    EXPECT_EQ( ToString( cpus ), "" );
+}
+
+TEST( CpuAffinityTest, RejectsMalformedCpuSets )
+{
+    CpuSet cpus;
+    EXPECT_FALSE( ParseCpuSet( "1-", cpus ) );
+    EXPECT_FALSE( ParseCpuSet( "a", cpus ) );
+    EXPECT_FALSE( ParseCpuSet( "3-1", cpus ) );
+    EXPECT_FALSE( ParseCpuSet( "1,,2", cpus ) );
+    EXPECT_FALSE( ParseCpuSet( std::to_string( Partition::maxNumberOfCpus ), cpus ) );
+}
+
+TEST( CpuAffinityTest, ParsesLayouts )
+{
+    Layout layout;
+    ASSERT_TRUE( Layout::Parse( "decode=0-1; inference=4-7;render=3", layout ) );
+    EXPECT_EQ( layout[ Stage::Decode ], ( CpuSet{ 0, 1 } ) );
+    EXPECT_TRUE( layout[ Stage::Preprocess ].empty( ) );
+    EXPECT_EQ( layout[ Stage::Inference ], ( CpuSet{ 4, 5, 6, 7 } ) );
+    EXPECT_EQ( layout[ Stage::Render ], ( CpuSet{ 3 } ) );
+    EXPECT_TRUE( layout.IsPinned( ) );
+
+    ASSERT_TRUE( Layout::Parse( "", layout ) );
+    EXPECT_FALSE( layout.IsPinned( ) );
+    EXPECT_EQ( layout.name, "unpinned" );
+
+    EXPECT_FALSE( Layout::Parse( "gpu=0", layout ) );
+    EXPECT_FALSE( Layout::Parse( "decode", layout ) );
+    EXPECT_FALSE( Layout::Parse( "decode=x", layout ) );
+}
+
+TEST( CpuAffinityTest, ScopedStagePinsAndRestores )
+{
+    if ( !CanPin( ) )
+        GTEST_SKIP( ) << "Thread affinity is not supported on this platform";
+
+    CpuSet original;
+    ASSERT_TRUE( GetCurrentThreadAffinity( original ) );
+    const int cpu = original.front( );
+
+    Layout layout;
+    ASSERT_TRUE( Layout::Parse( "render=" + std::to_string( cpu ), layout ) );
+    Partition::Global( ).Configure( layout, MakeLogger( ) );
+    {
+        const ScopedStage stage( Stage::Render );
+        CpuSet pinned;
+        ASSERT_TRUE( GetCurrentThreadAffinity( pinned ) );
+        EXPECT_EQ( pinned, CpuSet{ cpu } );
+        EXPECT_EQ( CurrentCpu( ), cpu );
+    }
+    CpuSet restored;
+    ASSERT_TRUE( GetCurrentThreadAffinity( restored ) );
+    EXPECT_EQ( restored, original );
+    EXPECT_EQ( Partition::Global( ).ObservedCpus( Stage::Render ), CpuSet{ cpu } );
+
+    Partition::Global( ).Configure( Layout{ }, MakeLogger( ) );
+}
+
+TEST( CpuAffinityTest, ThreadPoolWorkersEnterDecodeStage )
+{
+    if ( !CanPin( ) )
+        GTEST_SKIP( ) << "Thread affinity is not supported on this platform";
+
+    CpuSet original;
+    ASSERT_TRUE( GetCurrentThreadAffinity( original ) );
+    const int cpu = original.back( );
+
+    Layout layout;
+    ASSERT_TRUE( Layout::Parse( "decode=" + std::to_string( cpu ), layout ) );
+    Partition::Global( ).Configure( layout, MakeLogger( ) );
+    {
+        ThreadPool pool( 2, []( ) { Partition::Global( ).Enter( Stage::Decode ); } );
+        for ( int i = 0; i < 8; ++i ) {
+            auto affinity = pool.Submit( []( ) {
+                CpuSet cpus;
+                GetCurrentThreadAffinity( cpus );
+                return cpus;
+            } );
+            EXPECT_EQ( affinity.get( ), CpuSet{ cpu } );
+        }
+    }
+    EXPECT_EQ( Partition::Global( ).ObservedCpus( Stage::Decode ), CpuSet{ cpu } );
+
+    const std::string report = Partition::Global( ).Report( );
+    EXPECT_NE( report.find( "decode" ), std::string::npos );
+    EXPECT_NE( report.find( layout.name ), std::string::npos );
+
+    Partition::Global( ).Configure( Layout{ }, MakeLogger( ) );
+}
+
+TEST( CpuAffinityTest, ThreadsEnteringUnpinnedStagesAreReset )
+{
+    if ( !CanPin( ) )
+        GTEST_SKIP( ) << "Thread affinity is not supported on this platform";
+
+    CpuSet original;
+    ASSERT_TRUE( GetCurrentThreadAffinity( original ) );
+
+    Layout layout;
+    ASSERT_TRUE( Layout::Parse( "preprocess=" + std::to_string( original.front( ) ), layout ) );
+    Partition::Global( ).Configure( layout, MakeLogger( ) );
+    {
+        // * A thread created from the pinned preprocess thread inherits its CPU until it enters its own stage
+        const ScopedStage stage( Stage::Preprocess );
+        CpuSet inherited;
+        CpuSet entered;
+        std::thread( [ & ]( ) {
+            GetCurrentThreadAffinity( inherited );
+            Partition::Global( ).Enter( Stage::Inference );
+            GetCurrentThreadAffinity( entered );
+        } ).join( );
+        EXPECT_EQ( inherited, CpuSet{ original.front( ) } );
+        EXPECT_EQ( entered, original );
+    }
+
+    Partition::Global( ).Configure( Layout{ }, MakeLogger( ) );
+}
+
+TEST( CpuAffinityTest, UnpinnedLayoutLeavesThreadsAlone )
+{
+    Partition::Global( ).Configure( Layout{ }, MakeLogger( ) );
+    CpuSet before;
+    GetCurrentThreadAffinity( before );
+    std::thread( []( ) { Partition::Global( ).Enter( Stage::Preprocess ); } ).join( );
+    {
+        const ScopedStage stage( Stage::Render );
+    }
+    CpuSet after;
+    GetCurrentThreadAffinity( after );
+    EXPECT_EQ( before, after );
+}
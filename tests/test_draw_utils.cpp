@@ -0,0 +1,64 @@
+#include "DrawUtils.hpp"
+#include "SyntheticData.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+PoseEstimator::Detection MakeDetection( float boxScore, float keyPointScore )
+{
+    PoseEstimator::Detection detection{ };
+    detection.box = { .tlX = 10.f, .tlY = 10.f, .brX = 50.f, .brY = 70.f, .score = boxScore, .label = 0.f };
+    for ( auto& keyPoint : detection.keyPoints )
+        keyPoint = { .x = 30.f, .y = 40.f, .score = keyPointScore };
+    return detection;
+}
+
+} // namespace
+
+TEST( DrawUtilsTest, NoDetectionsYieldsEmptyOverlay )
+{
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 80, 60 }, CV_8UC3, { } );
+    EXPECT_EQ( frame.size( ), cv::Size( 80, 60 ) );
+    EXPECT_EQ( frame.type( ), CV_8UC3 );
+    EXPECT_EQ( cv::countNonZero( frame.reshape( 1 ) ), 0 );
+}
+
+TEST( DrawUtilsTest, LowConfidenceDetectionsAreSkipped )
+{
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 80, 80 }, CV_8UC3, { MakeDetection( 0.1f, 0.9f ) } );
+    EXPECT_EQ( cv::countNonZero( frame.reshape( 1 ) ), 0 );
+}
+
+TEST( DrawUtilsTest, DrawsBoxAndJoints )
+{
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 80, 80 }, CV_8UC3, { MakeDetection( 0.9f, 0.9f ) } );
+    EXPECT_EQ( frame.at<cv::Vec3b>( 10, 30 ), cv::Vec3b( 200, 0, 0 ) ); // * Top edge of box
+    EXPECT_EQ( frame.at<cv::Vec3b>( 40, 32 ), cv::Vec3b( 0, 0, 200 ) ); // * Joint, off the degenerate skeleton
+    EXPECT_EQ( frame.at<cv::Vec3b>( 40, 70 ), cv::Vec3b( 0, 0, 0 ) );   // * Outside
+}
+
+TEST( DrawUtilsTest, LowConfidenceKeyPointsAreSkipped )
+{
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 80, 80 }, CV_8UC3, { MakeDetection( 0.9f, 0.1f ) } );
+    EXPECT_EQ( frame.at<cv::Vec3b>( 10, 30 ), cv::Vec3b( 200, 0, 0 ) );
+    EXPECT_EQ( frame.at<cv::Vec3b>( 40, 32 ), cv::Vec3b( 0, 0, 0 ) );
+}
+
+TEST( DrawUtilsTest, AppliesScaleFactor )
+{
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame(
+        { 160, 80 }, CV_8UC3, { MakeDetection( 0.9f, 0.9f ) }, { .wFactor = 2.f, .hFactor = 1.f }
+    );
+    EXPECT_EQ( frame.at<cv::Vec3b>( 40, 62 ), cv::Vec3b( 0, 0, 200 ) );
+    EXPECT_EQ( frame.at<cv::Vec3b>( 40, 32 ), cv::Vec3b( 0, 0, 0 ) );
+}
+
+TEST( DrawUtilsTest, DrawsSyntheticModelDetections )
+{
+    const auto detections = SyntheticData::MakeDetections( );
+    const cv::Mat frame = DrawUtils::DrawPosesInFrame(
+        { SyntheticData::modelInputSize, SyntheticData::modelInputSize }, CV_8UC3, detections
+    );
+    EXPECT_GT( cv::countNonZero( frame.reshape( 1 ) ), 0 );
+}
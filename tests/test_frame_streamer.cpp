@@ -0,0 +1,396 @@
+#include "FrameStreamer.hpp"
+#include "SyntheticData.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::unique_ptr<Logger::ILogger> MakeLogger( )
+{
+    return std::make_unique<Logger::CoutLogger>( Logger::Priority::Error );
+}
+
+// * Mean over all channels, frames are uniform so this recovers the level written by SyntheticData
+double FrameLevel( const cv::Mat& frame )
+{
+    const cv::Scalar mean = cv::mean( frame );
+    return ( mean[ 0 ] + mean[ 1 ] + mean[ 2 ] ) / 3.;
+}
+
+constexpr double levelTolerance = 4.;
+
+// * Move-only result which remembers the level of the frame it was computed from
+struct LevelResult {
+    std::vector<double> levels;
+
+    LevelResult( ) = default;
+    LevelResult( LevelResult&& ) noexcept = default;
+    LevelResult& operator=( LevelResult&& ) noexcept = default;
+    LevelResult( const LevelResult& ) = delete;
+    LevelResult& operator=( const LevelResult& ) = delete;
+
+    cv::Mat Overlay( const cv::Size& size, int type ) const { return cv::Mat::zeros( size, type ); }
+};
+
+struct LevelProcessor {
+    using Result = LevelResult;
+
+    void operator( )( const cv::Mat& frame, Result& result )
+    {
+        if ( gate.valid( ) )
+            gate.wait( );
+        result.levels.assign( 1, FrameLevel( frame ) );
+        ++calls;
+    }
+
+    std::shared_future<void> gate;
+    std::atomic<int> calls = 0;
+};
+
+static_assert( FrameProcessor<LevelProcessor> );
+static_assert( !FrameResult<std::vector<double>> );
+
+bool CollectWithin( AsyncFrameProcessor<LevelProcessor>& processor, LevelResult& result )
+{
+    const auto deadline = std::chrono::steady_clock::now( ) + std::chrono::seconds( 5 );
+    while ( std::chrono::steady_clock::now( ) < deadline ) {
+        if ( processor.TryCollect( result ) )
+            return true;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return false;
+}
+
+} // namespace
+
+class VideoStreamerTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sVideoFilePath = sDirectory->Path( ) / "synthetic.avi";
+        ASSERT_TRUE( SyntheticData::WriteVideo( sVideoFilePath, frameSize, numberOfFrames, 25. ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    static constexpr int numberOfFrames = 5;
+    static inline const cv::Size frameSize{ 96, 64 };
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sVideoFilePath;
+};
+
+TEST_F( VideoStreamerTest, CreateFrameStreamerFailsOnMissingFile )
+{
+    EXPECT_EQ( CreateFrameStreamer<VideoStreamer>( ( sDirectory->Path( ) / "missing.avi" ).string( ) ), nullptr );
+}
+
+TEST_F( VideoStreamerTest, CreateFrameStreamerSucceedsOnSyntheticVideo )
+{
+    EXPECT_NE( CreateFrameStreamer<VideoStreamer>( sVideoFilePath.string( ) ), nullptr );
+}
+
+TEST_F( VideoStreamerTest, AcquiresFramesInOrderAndLoops )
+{
+    VideoStreamer streamer( sVideoFilePath.string( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+
+    cv::Mat frame;
+    for ( int i = 0; i < 2 * numberOfFrames; ++i ) {
+        ASSERT_TRUE( streamer.AcquireNextFrame( frame ) );
+        EXPECT_EQ( frame.size( ), frameSize );
+        EXPECT_EQ( frame.type( ), CV_8UC3 );
+        EXPECT_NEAR( FrameLevel( frame ), SyntheticData::FrameLevel( i % numberOfFrames ), levelTolerance );
+    }
+}
+
+TEST_F( VideoStreamerTest, AcquirePreviousFrameStepsBack )
+{
+    VideoStreamer streamer( sVideoFilePath.string( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+
+    cv::Mat frame;
+    for ( int i = 0; i < 3; ++i )
+        ASSERT_TRUE( streamer.AcquireNextFrame( frame ) );
+    ASSERT_TRUE( streamer.AcquirePreviousFrame( frame ) );
+    EXPECT_NEAR( FrameLevel( frame ), SyntheticData::FrameLevel( 1 ), levelTolerance );
+}
+
+TEST_F( VideoStreamerTest, DecodesOnTheDecodeCpus )
+{
+    CpuAffinity::CpuSet original;
+    if ( !CpuAffinity::GetCurrentThreadAffinity( original ) || original.empty( ) )
+        GTEST_SKIP( ) << "Thread affinity is not supported on this platform";
+
+    auto& partition = CpuAffinity::Partition::Global( );
+    CpuAffinity::Layout layout;
+    ASSERT_TRUE( CpuAffinity::Layout::Parse( "decode=" + std::to_string( original.back( ) ), layout ) );
+    partition.Configure( layout, MakeLogger( ) );
+    {
+        VideoStreamer streamer( sVideoFilePath.string( ) );
+        ASSERT_TRUE( streamer.Initialize( ) );
+        cv::Mat frame;
+        for ( int i = 0; i < 3; ++i )
+            ASSERT_TRUE( streamer.AcquireNextFrame( frame ) );
+        ASSERT_TRUE( streamer.AcquirePreviousFrame( frame ) );
+        EXPECT_NEAR( FrameLevel( frame ), SyntheticData::FrameLevel( 1 ), levelTolerance );
+    }
+    EXPECT_EQ( partition.ObservedCpus( CpuAffinity::Stage::Decode ), CpuAffinity::CpuSet{ original.back( ) } );
+
+    partition.Configure( CpuAffinity::Layout{ }, MakeLogger( ) );
+}
+
+TEST_F( VideoStreamerTest, AcquireFailsWhenUninitialized )
+{
+    VideoStreamer streamer( sVideoFilePath.string( ) );
+    cv::Mat frame;
+    EXPECT_FALSE( streamer.AcquireNextFrame( frame ) );
+    EXPECT_FALSE( streamer.AcquirePreviousFrame( frame ) );
+}
+
+// ##################################
+
+TEST( ImageStreamerTest, CreateFrameStreamerFailsOnMissingFile )
+{
+    SyntheticData::TemporaryDirectory directory;
+    EXPECT_EQ( CreateFrameStreamer<ImageStreamer>( ( directory.Path( ) / "missing.png" ).string( ) ), nullptr );
+}
+
+TEST( ImageStreamerTest, AcquiresIndependentCopiesOfTheImage )
+{
+    SyntheticData::TemporaryDirectory directory;
+    const auto imageFilePath = directory.Path( ) / "synthetic.png";
+    ASSERT_TRUE( SyntheticData::WriteImage( imageFilePath, { 32, 24 }, 100 ) );
+
+    ImageStreamer streamer( imageFilePath.string( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+
+    cv::Mat first;
+    cv::Mat second;
+    ASSERT_TRUE( streamer.AcquireNextFrame( first ) );
+    first.setTo( cv::Scalar::all( 0 ) );
+    ASSERT_TRUE( streamer.AcquirePreviousFrame( second ) );
+    EXPECT_EQ( second.size( ), cv::Size( 32, 24 ) );
+    EXPECT_DOUBLE_EQ( FrameLevel( second ), 100. );
+}
+
+// ##################################
+
+class ImageSequenceStreamerTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        for ( int i = 0; i < numberOfImages; ++i ) {
+            const auto imagePath = sDirectory->Path( ) / ( "frame_" + std::to_string( 100 + i ) + ".png" );
+            ASSERT_TRUE( SyntheticData::WriteImage( imagePath, { 40, 30 }, SyntheticData::FrameLevel( i ) ) );
+        }
+        std::ofstream( sDirectory->Path( ) / "notes.txt" ) << "not an image\n";
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    static void ExpectSequence( ImageSequenceStreamer& streamer, const std::vector<int>& expectedImages )
+    {
+        cv::Mat frame;
+        for ( const int image : expectedImages ) {
+            ASSERT_TRUE( streamer.AcquireNextFrame( frame ) );
+            EXPECT_EQ( frame.size( ), cv::Size( 40, 30 ) );
+            EXPECT_DOUBLE_EQ( FrameLevel( frame ), SyntheticData::FrameLevel( image ) );
+        }
+    }
+
+    static constexpr int numberOfImages = 7;
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+};
+
+TEST_F( ImageSequenceStreamerTest, StreamsDirectoryInSortedOrderAndLoops )
+{
+    ImageSequenceStreamer streamer( sDirectory->Path( ).string( ), MakeLogger( ), 3, 4 );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    EXPECT_EQ( streamer.ImagePaths( ).size( ), static_cast<size_t>( numberOfImages ) );
+    ExpectSequence( streamer, { 0, 1, 2, 3, 4, 5, 6, 0, 1 } );
+}
+
+TEST_F( ImageSequenceStreamerTest, StreamsGlobPattern )
+{
+    ImageSequenceStreamer streamer( ( sDirectory->Path( ) / "frame_10?.png" ).string( ), MakeLogger( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    EXPECT_EQ( streamer.ImagePaths( ).size( ), static_cast<size_t>( numberOfImages ) );
+    ExpectSequence( streamer, { 0, 1, 2 } );
+
+    ImageSequenceStreamer noMatch( ( sDirectory->Path( ) / "*.jpg" ).string( ), MakeLogger( ) );
+    EXPECT_FALSE( noMatch.Initialize( ) );
+}
+
+TEST_F( ImageSequenceStreamerTest, StreamsManifestInListedOrder )
+{
+    const auto manifestPath = sDirectory->Path( ) / "manifest.lst";
+    {
+        std::ofstream manifest( manifestPath );
+        manifest << "# comment\n";
+        manifest << "frame_103.png\n\n";
+        manifest << ( sDirectory->Path( ) / "frame_101.png" ).string( ) << "\n";
+        manifest << "frame_105.png\n";
+    }
+
+    ImageSequenceStreamer streamer( manifestPath.string( ), MakeLogger( ), 2 );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    ExpectSequence( streamer, { 3, 1, 5, 3 } );
+}
+
+TEST_F( ImageSequenceStreamerTest, StreamsSingleImage )
+{
+    ImageSequenceStreamer streamer( ( sDirectory->Path( ) / "frame_102.png" ).string( ), MakeLogger( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    EXPECT_EQ( streamer.ImagePaths( ).size( ), 1u );
+    ExpectSequence( streamer, { 2, 2 } );
+}
+
+TEST_F( ImageSequenceStreamerTest, ManifestWithMissingEntryFailsToInitialize )
+{
+    const auto manifestPath = sDirectory->Path( ) / "missing-entry.lst";
+    std::ofstream( manifestPath ) << "frame_101.png\nframe_999.png\n";
+
+    ImageSequenceStreamer streamer( manifestPath.string( ), MakeLogger( ) );
+    EXPECT_FALSE( streamer.Initialize( ) );
+    cv::Mat frame;
+    EXPECT_FALSE( streamer.AcquireNextFrame( frame ) );
+}
+
+TEST_F( ImageSequenceStreamerTest, SkipsUndecodableImages )
+{
+    const cv::Size size( 40, 30 );
+    SyntheticData::TemporaryDirectory directory;
+    ASSERT_TRUE( SyntheticData::WriteImage( directory.Path( ) / "frame_0.png", size, SyntheticData::FrameLevel( 0 ) ) );
+    std::ofstream( directory.Path( ) / "frame_1.png" ) << "not an image\n";
+    ASSERT_TRUE( SyntheticData::WriteImage( directory.Path( ) / "frame_2.png", size, SyntheticData::FrameLevel( 2 ) ) );
+
+    ImageSequenceStreamer streamer( directory.Path( ).string( ), MakeLogger( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    cv::Mat frame;
+    for ( const int image : { 0, 2, 0, 2 } ) {
+        ASSERT_TRUE( streamer.AcquireNextFrame( frame ) );
+        EXPECT_DOUBLE_EQ( FrameLevel( frame ), SyntheticData::FrameLevel( image ) );
+    }
+
+    SyntheticData::TemporaryDirectory corruptDirectory;
+    std::ofstream( corruptDirectory.Path( ) / "frame_0.png" ) << "not an image\n";
+    ImageSequenceStreamer corrupt( corruptDirectory.Path( ).string( ), MakeLogger( ) );
+    ASSERT_TRUE( corrupt.Initialize( ) );
+    EXPECT_FALSE( corrupt.AcquireNextFrame( frame ) );
+}
+
+TEST_F( ImageSequenceStreamerTest, AcquirePreviousFrameStepsBack )
+{
+    ImageSequenceStreamer streamer( sDirectory->Path( ).string( ), MakeLogger( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    ExpectSequence( streamer, { 0, 1, 2 } );
+
+    cv::Mat frame;
+    ASSERT_TRUE( streamer.AcquirePreviousFrame( frame ) );
+    EXPECT_DOUBLE_EQ( FrameLevel( frame ), SyntheticData::FrameLevel( 1 ) );
+    ExpectSequence( streamer, { 2, 3 } );
+}
+
+TEST_F( ImageSequenceStreamerTest, RepeatedRestartsKeepTheSequence )
+{
+    // * Every step back cancels a full prefetch queue on a single decoder
+    ImageSequenceStreamer streamer( sDirectory->Path( ).string( ), MakeLogger( ), 1, numberOfImages );
+    ASSERT_TRUE( streamer.Initialize( ) );
+    ExpectSequence( streamer, { 0, 1, 2, 3 } );
+
+    cv::Mat frame;
+    for ( const int image : { 2, 1, 0, 6, 5 } ) {
+        ASSERT_TRUE( streamer.AcquirePreviousFrame( frame ) );
+        EXPECT_DOUBLE_EQ( FrameLevel( frame ), SyntheticData::FrameLevel( image ) );
+    }
+    ExpectSequence( streamer, { 6, 0, 1 } );
+}
+
+TEST_F( ImageSequenceStreamerTest, CreateFrameStreamerFailsOnMissingSource )
+{
+    const auto missingSource = ( sDirectory->Path( ) / "missing" ).string( );
+    EXPECT_EQ( CreateFrameStreamer<ImageSequenceStreamer>( missingSource, MakeLogger( ) ), nullptr );
+    EXPECT_NE( CreateFrameStreamer<ImageSequenceStreamer>( sDirectory->Path( ).string( ), MakeLogger( ) ), nullptr );
+}
+
+// ##################################
+
+TEST( AsyncFrameProcessorTest, ProcessesSubmittedFrames )
+{
+    LevelProcessor levelProcessor;
+    AsyncFrameProcessor<LevelProcessor> processor( levelProcessor );
+    LevelResult result;
+    EXPECT_FALSE( processor.TryCollect( result ) );
+
+    for ( int level : { 10, 20, 30 } ) {
+        ASSERT_TRUE( processor.Submit( cv::Mat( 8, 8, CV_8UC3, cv::Scalar::all( level ) ) ) );
+        ASSERT_TRUE( CollectWithin( processor, result ) );
+        ASSERT_EQ( result.levels.size( ), 1u );
+        EXPECT_DOUBLE_EQ( result.levels.front( ), level );
+    }
+    EXPECT_EQ( levelProcessor.calls.load( ), 3 );
+}
+
+TEST( AsyncFrameProcessorTest, DropsFramesWhileBusy )
+{
+    std::promise<void> release;
+    LevelProcessor levelProcessor;
+    levelProcessor.gate = release.get_future( ).share( );
+    AsyncFrameProcessor<LevelProcessor> processor( levelProcessor );
+
+    cv::Mat frame( 8, 8, CV_8UC3, cv::Scalar::all( 10 ) );
+    ASSERT_TRUE( processor.Submit( frame ) );
+    // * The frame is copied on submission, later changes by the caller are not seen by the processor
+    frame.setTo( cv::Scalar::all( 50 ) );
+    EXPECT_FALSE( processor.Submit( frame ) );
+
+    release.set_value( );
+    LevelResult result;
+    ASSERT_TRUE( CollectWithin( processor, result ) );
+    EXPECT_DOUBLE_EQ( result.levels.front( ), 10. );
+    EXPECT_EQ( levelProcessor.calls.load( ), 1 );
+}
+
+TEST( AsyncFrameProcessorTest, RecyclesResultStorage )
+{
+    LevelProcessor levelProcessor;
+    AsyncFrameProcessor<LevelProcessor> processor( levelProcessor );
+    const cv::Mat frame( 8, 8, CV_8UC3, cv::Scalar::all( 10 ) );
+
+    LevelResult result;
+    ASSERT_TRUE( processor.Submit( frame ) );
+    ASSERT_TRUE( CollectWithin( processor, result ) );
+    const double* firstStorage = result.levels.data( );
+
+    // * The first result goes to the free list when the second is collected and is reused by the third
+    ASSERT_TRUE( processor.Submit( frame ) );
+    ASSERT_TRUE( CollectWithin( processor, result ) );
+    ASSERT_TRUE( processor.Submit( frame ) );
+    ASSERT_TRUE( CollectWithin( processor, result ) );
+    EXPECT_EQ( result.levels.data( ), firstStorage );
+}
+
+TEST( ResultPoolTest, ReusesReleasedResults )
+{
+    ResultPool<LevelResult> pool;
+    LevelResult result = pool.Acquire( );
+    result.levels.assign( 4, 1. );
+    const double* storage = result.levels.data( );
+    pool.Release( std::move( result ) );
+    EXPECT_EQ( pool.Size( ), 1u );
+
+    const LevelResult reused = pool.Acquire( );
+    EXPECT_EQ( reused.levels.data( ), storage );
+    EXPECT_EQ( pool.Size( ), 0u );
+    EXPECT_TRUE( pool.Acquire( ).levels.empty( ) );
+}
@@ -0,0 +1,214 @@
+#include "OpenCvDnnInferenceEngine.hpp"
+#include "OrtInferenceEngine.hpp"
+#include "PoseEstimator.hpp"
+#include "SyntheticData.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class InferenceEngineTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        sBatchModelFilePath = sDirectory->Path( ) / "synthetic-pose-batch.onnx";
+        const auto anchors = SyntheticData::MakeDetections( );
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, anchors ) );
+        ASSERT_TRUE( SyntheticData::WriteModel( sBatchModelFilePath, anchors, SyntheticData::modelInputSize, true ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    static std::vector<float> MakeInput( )
+    {
+        // * Non uniform so that a wrong reduction or layout shows up in the output
+        const int size = SyntheticData::modelInputSize;
+        std::vector<float> input( 3 * size * size );
+        for ( size_t i = 0; i < input.size( ); ++i )
+            input[ i ] = static_cast<float>( i % 255 ) / 255.f;
+        return input;
+    }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+    static inline std::filesystem::path sBatchModelFilePath;
+    Logger::CoutLogger mLogger{ Logger::Priority::Error };
+};
+
+namespace {
+
+// * Runs three distinct inputs through ForwardBatch and checks every output against Forward on the same input
+void ExpectBatchMatchesForward( InferenceEngine& engine, const std::vector<float>& input )
+{
+    std::vector<float> second( input.size( ), 0.f );
+    std::vector<float> third( input.size( ), 1.f );
+    const std::vector<const float*> inputs{ input.data( ), second.data( ), third.data( ) };
+    std::vector<InferenceEngine::Tensor> outputs;
+    ASSERT_TRUE( engine.ForwardBatch( inputs, outputs ) );
+    ASSERT_EQ( outputs.size( ), inputs.size( ) );
+
+    for ( size_t i = 0; i < inputs.size( ); ++i ) {
+        InferenceEngine::Tensor expected;
+        ASSERT_TRUE( engine.Forward( inputs[ i ], expected ) );
+        EXPECT_EQ( outputs[ i ].shape, expected.shape ) << "input " << i;
+        ASSERT_EQ( outputs[ i ].data.size( ), expected.data.size( ) ) << "input " << i;
+        for ( size_t j = 0; j < expected.data.size( ); ++j )
+            EXPECT_NEAR( outputs[ i ].data[ j ], expected.data[ j ], 1e-4f ) << "input " << i << " at " << j;
+    }
+    EXPECT_NE( outputs[ 0 ].data, outputs[ 1 ].data );
+}
+
+} // namespace
+
+TEST_F( InferenceEngineTest, OrtEngineReportsInputShape )
+{
+    OrtInferenceEngine engine( mLogger, OrtInferenceEngine::ExecutionProvider::Cpu, "test" );
+    ASSERT_TRUE( engine.Initialize( sModelFilePath ) );
+    const int64_t size = SyntheticData::modelInputSize;
+    EXPECT_EQ( engine.GetInputShape( ), ( std::vector<int64_t>{ 1, 3, size, size } ) );
+    EXPECT_EQ( engine.Name( ), "onnxruntime-cpu" );
+}
+
+TEST_F( InferenceEngineTest, OpenCvEngineReportsInputShape )
+{
+    OpenCvDnnInferenceEngine engine( mLogger, OpenCvDnnInferenceEngine::Target::Cpu );
+    if ( !engine.Initialize( sModelFilePath ) )
+        GTEST_SKIP( ) << "cv::dnn could not import the synthetic model";
+    const int64_t size = SyntheticData::modelInputSize;
+    EXPECT_EQ( engine.GetInputShape( ), ( std::vector<int64_t>{ 1, 3, size, size } ) );
+}
+
+TEST_F( InferenceEngineTest, OpenCvEngineMatchesOrtEngine )
+{
+    OrtInferenceEngine ort( mLogger, OrtInferenceEngine::ExecutionProvider::Cpu, "test" );
+    ASSERT_TRUE( ort.Initialize( sModelFilePath ) );
+    OpenCvDnnInferenceEngine openCv( mLogger, OpenCvDnnInferenceEngine::Target::Cpu );
+    if ( !openCv.Initialize( sModelFilePath ) )
+        GTEST_SKIP( ) << "cv::dnn could not import the synthetic model";
+
+    const auto input = MakeInput( );
+    InferenceEngine::Tensor expected;
+    InferenceEngine::Tensor actual;
+    ASSERT_TRUE( ort.Forward( input.data( ), expected ) );
+    ASSERT_TRUE( openCv.Forward( input.data( ), actual ) );
+
+    ASSERT_FALSE( actual.shape.empty( ) );
+    EXPECT_EQ( actual.shape.front( ), expected.shape.front( ) );
+    ASSERT_EQ( actual.data.size( ), expected.data.size( ) );
+    for ( size_t i = 0; i < actual.data.size( ); ++i )
+        EXPECT_NEAR( actual.data[ i ], expected.data[ i ], 1e-4f ) << "at " << i;
+}
+
+TEST_F( InferenceEngineTest, ForwardBatchRunsEveryInput )
+{
+    // * A fixed batch of 1 falls back to one Forward call per input
+    OrtInferenceEngine engine( mLogger, OrtInferenceEngine::ExecutionProvider::Cpu, "test" );
+    ASSERT_TRUE( engine.Initialize( sModelFilePath ) );
+    ExpectBatchMatchesForward( engine, MakeInput( ) );
+}
+
+TEST_F( InferenceEngineTest, OrtEngineRunsDynamicBatch )
+{
+    OrtInferenceEngine engine( mLogger, OrtInferenceEngine::ExecutionProvider::Cpu, "test" );
+    ASSERT_TRUE( engine.Initialize( sBatchModelFilePath ) );
+    const int64_t size = SyntheticData::modelInputSize;
+    EXPECT_EQ( engine.GetInputShape( ), ( std::vector<int64_t>{ 1, 3, size, size } ) );
+
+    InferenceEngine::Tensor output;
+    ASSERT_TRUE( engine.Forward( MakeInput( ).data( ), output ) );
+    EXPECT_EQ( output.shape, ( std::vector<int64_t>{ SyntheticData::numberOfDetections, 57 } ) );
+    ExpectBatchMatchesForward( engine, MakeInput( ) );
+}
+
+TEST_F( InferenceEngineTest, OpenCvEngineRunsDynamicBatch )
+{
+    OpenCvDnnInferenceEngine engine( mLogger, OpenCvDnnInferenceEngine::Target::Cpu );
+    if ( !engine.Initialize( sBatchModelFilePath ) )
+        GTEST_SKIP( ) << "cv::dnn could not import the synthetic model";
+
+    InferenceEngine::Tensor output;
+    ASSERT_TRUE( engine.Forward( MakeInput( ).data( ), output ) );
+    EXPECT_EQ( output.shape, ( std::vector<int64_t>{ SyntheticData::numberOfDetections, 57 } ) );
+    ExpectBatchMatchesForward( engine, MakeInput( ) );
+}
+
+TEST_F( InferenceEngineTest, PoseEstimatorForwardBatchMatchesForward )
+{
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( sBatchModelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+
+    const int size = SyntheticData::modelInputSize;
+    std::vector<std::vector<float>> frames;
+    std::vector<float*> framesData;
+    for ( int i = 0; i < 5; ++i ) {
+        frames.emplace_back( 3 * size * size, 0.1f * i );
+        framesData.push_back( frames.back( ).data( ) );
+    }
+
+    std::vector<std::vector<PoseEstimator::Detection>> batched;
+    ASSERT_TRUE( model.ForwardBatch( batched, framesData, size, size, 3 ) );
+    std::vector<std::vector<PoseEstimator::Detection>> parallel;
+    ASSERT_TRUE( model.ForwardParallel( parallel, framesData, size, size, 3, 2 ) );
+    ASSERT_EQ( batched.size( ), frames.size( ) );
+    ASSERT_EQ( parallel.size( ), frames.size( ) );
+    for ( size_t i = 0; i < frames.size( ); ++i ) {
+        std::vector<PoseEstimator::Detection> serial;
+        ASSERT_TRUE( model.Forward( serial, framesData[ i ], size, size, 3 ) );
+        ASSERT_EQ( batched[ i ].size( ), serial.size( ) );
+        ASSERT_EQ( parallel[ i ].size( ), serial.size( ) );
+        EXPECT_NEAR( batched[ i ][ 0 ].box.tlX, serial[ 0 ].box.tlX, 1e-5f );
+        EXPECT_NEAR( parallel[ i ][ 0 ].box.tlX, serial[ 0 ].box.tlX, 1e-5f );
+    }
+    EXPECT_GE( model.Benchmark( 2, 4 ), 0.f );
+}
+
+TEST_F( InferenceEngineTest, PoseEstimatorRunsOnOpenCvBackend )
+{
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    if ( !model.Initialize( sModelFilePath, PoseEstimator::RuntimeBackend::OpenCvDnn ) )
+        GTEST_SKIP( ) << "cv::dnn could not import the synthetic model";
+
+    const int size = SyntheticData::modelInputSize;
+    const std::vector<float> input( 3 * size * size, 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( model.Forward( detections, const_cast<float*>( input.data( ) ), size, size, 3 ) );
+    EXPECT_EQ( detections.size( ), static_cast<size_t>( SyntheticData::numberOfDetections ) );
+    EXPECT_NEAR( detections.front( ).box.tlX, SyntheticData::MakeDetections( ).front( ).box.tlX, 1e-4f );
+}
+
+TEST_F( InferenceEngineTest, InitializeWithNullEngineFails )
+{
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    EXPECT_FALSE( model.Initialize( sModelFilePath, std::unique_ptr<InferenceEngine>( ) ) );
+}
+
+TEST_F( InferenceEngineTest, PoseEstimatorRejectsMalformedOutput )
+{
+    const InferenceEngine::Tensor validOutput{ { 2, 57 }, std::vector<float>( 114 ) };
+    auto engine = std::make_unique<SyntheticData::FixedOutputEngine>( validOutput, 8 );
+    SyntheticData::FixedOutputEngine& fixedEngine = *engine;
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( sModelFilePath, std::move( engine ) ) );
+
+    std::vector<float> input( 3 * 8 * 8, 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( model.Forward( detections, input.data( ), 8, 8, 3 ) );
+    EXPECT_EQ( detections.size( ), 2u );
+
+    const std::vector<InferenceEngine::Tensor> malformed{
+        { { 2, 56 }, std::vector<float>( 112 ) },   // * Wrong number of values per detection
+        { { 114 }, std::vector<float>( 114 ) },     // * Not [ N, 57 ]
+        { { 1, 2, 57 }, std::vector<float>( 114 ) },
+        { { 2, 57 }, std::vector<float>( 100 ) } }; // * Data does not match the shape
+    for ( const auto& output : malformed ) {
+        fixedEngine.mOutput = output;
+        EXPECT_FALSE( model.Forward( detections, input.data( ), 8, 8, 3 ) );
+    }
+
+    fixedEngine.mOutput = { { 0, 57 }, { } };
+    ASSERT_TRUE( model.Forward( detections, input.data( ), 8, 8, 3 ) );
+    EXPECT_TRUE( detections.empty( ) );
+}
@@ -0,0 +1,173 @@
+#include "Metrics.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifndef _WIN32
+// * -1 on failure
+int Connect( uint16_t port )
+{
+    const int s = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+    sockaddr_in address{ };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    address.sin_port = htons( port );
+    if ( connect( s, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) != 0 ) {
+        close( s );
+        return -1;
+    }
+    return s;
+}
+
+std::string HttpGet( uint16_t port, const std::string& path )
+{
+    const int s = Connect( port );
+    if ( s < 0 )
+        return { };
+
+    const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send( s, request.data( ), request.size( ), 0 );
+
+    std::string response;
+    char buffer[ 4096 ];
+    ssize_t n;
+    while ( ( n = recv( s, buffer, sizeof( buffer ), 0 ) ) > 0 )
+        response.append( buffer, n );
+    close( s );
+    return response;
+}
+#endif
+
+std::unique_ptr<Logger::ILogger> MakeLogger( )
+{
+    return std::make_unique<Logger::CoutLogger>( Logger::Priority::Error );
+}
+
+} // namespace
+
+TEST( MetricsTest, CountersAreLockFreeAndConsistentUnderContention )
+{
+    static_assert( std::atomic<uint64_t>::is_always_lock_free );
+
+    Metrics::Registry registry;
+    auto& counter = registry.GetCounter( "test_total", "Test counter" );
+    auto& histogram = registry.GetHistogram( "test_seconds", "Test histogram" );
+
+    constexpr int numberOfThreads = 4;
+    constexpr int iterations = 10000;
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < numberOfThreads; ++t ) {
+        threads.emplace_back( [ & ] {
+            for ( int i = 0; i < iterations; ++i ) {
+                counter.Increment( );
+                histogram.Observe( 0.002 );
+            }
+        } );
+    }
+    for ( auto& thread : threads )
+        thread.join( );
+
+    EXPECT_EQ( counter.Value( ), numberOfThreads * iterations );
+    EXPECT_EQ( histogram.Count( ), numberOfThreads * iterations );
+    EXPECT_NEAR( histogram.Sum( ), numberOfThreads * iterations * 0.002, 1e-6 );
+}
+
+TEST( MetricsTest, RegistryReturnsSameMetricForSameName )
+{
+    Metrics::Registry registry;
+    auto& a = registry.GetCounter( "frames_total", "Frames" );
+    auto& b = registry.GetCounter( "frames_total", "Frames" );
+    EXPECT_EQ( &a, &b );
+    EXPECT_THROW( registry.GetGauge( "frames_total", "Frames" ), std::invalid_argument );
+}
+
+TEST( MetricsTest, SerializesPrometheusTextFormat )
+{
+    Metrics::Registry registry;
+    registry.GetCounter( "frames_total", "Frames" ).Increment( 3 );
+    registry.GetGauge( "queue_depth", "Queue depth" ).Set( 1 );
+    auto& histogram = registry.GetHistogram( "latency_seconds", "Latency", { 0.01, 0.1 } );
+    histogram.Observe( 0.005 );
+    histogram.Observe( 0.05 );
+    histogram.Observe( 1. );
+
+    const std::string text = registry.Serialize( );
+    EXPECT_NE( text.find( "# TYPE frames_total counter\nframes_total 3\n" ), std::string::npos );
+    EXPECT_NE( text.find( "# TYPE queue_depth gauge\nqueue_depth 1\n" ), std::string::npos );
+    EXPECT_NE( text.find( "latency_seconds_bucket{le=\"0.01\"} 1\n" ), std::string::npos );
+    EXPECT_NE( text.find( "latency_seconds_bucket{le=\"0.1\"} 2\n" ), std::string::npos );
+    EXPECT_NE( text.find( "latency_seconds_bucket{le=\"+Inf\"} 3\n" ), std::string::npos );
+    EXPECT_NE( text.find( "latency_seconds_count 3\n" ), std::string::npos );
+}
+
+TEST( MetricsTest, PipelineMetricsAreRegisteredGlobally )
+{
+    Metrics::PipelineMetrics::Get( ).droppedFrames.Increment( );
+    const std::string text = Metrics::Registry::Global( ).Serialize( );
+    for ( const char* name :
+          { "yolo_pose_inference_frames_total",
+            "yolo_pose_display_frames_total",
+            "yolo_pose_dropped_frames_total",
+            "yolo_pose_queue_depth",
+            "yolo_pose_forward_latency_seconds_count" } )
+        EXPECT_NE( text.find( name ), std::string::npos ) << name;
+}
+
+#ifndef _WIN32
+TEST( MetricsTest, HttpEndpointServesMetricsOnLocalhost )
+{
+    Metrics::Registry registry;
+    registry.GetCounter( "frames_total", "Frames" ).Increment( 7 );
+
+    Metrics::HttpEndpoint endpoint( registry, MakeLogger( ) );
+    ASSERT_TRUE( endpoint.Start( 0 ) );
+    ASSERT_NE( endpoint.Port( ), 0 );
+
+    const std::string response = HttpGet( endpoint.Port( ), "/metrics" );
+    EXPECT_TRUE( response.starts_with( "HTTP/1.1 200 OK" ) ) << response;
+    EXPECT_NE( response.find( "Content-Type: text/plain; version=0.0.4" ), std::string::npos );
+    EXPECT_NE( response.find( "frames_total 7" ), std::string::npos );
+
+    EXPECT_TRUE( HttpGet( endpoint.Port( ), "/other" ).starts_with( "HTTP/1.1 404" ) );
+
+    endpoint.Stop( );
+    EXPECT_TRUE( HttpGet( endpoint.Port( ), "/metrics" ).empty( ) );
+}
+
+TEST( MetricsTest, HttpEndpointDropsSilentClients )
+{
+    Metrics::Registry registry;
+    Metrics::HttpEndpoint endpoint( registry, MakeLogger( ) );
+    ASSERT_TRUE( endpoint.Start( 0 ) );
+
+    // * A client which never sends is closed after the request timeout and does not block the next scrape
+    const int silentClient = Connect( endpoint.Port( ) );
+    ASSERT_GE( silentClient, 0 );
+    EXPECT_TRUE( HttpGet( endpoint.Port( ), "/metrics" ).starts_with( "HTTP/1.1 200 OK" ) );
+    char buffer[ 16 ];
+    EXPECT_EQ( recv( silentClient, buffer, sizeof( buffer ), 0 ), 0 );
+    close( silentClient );
+
+    // * Stop( ) does not wait for the timeout of a connected silent client
+    const int pendingClient = Connect( endpoint.Port( ) );
+    ASSERT_GE( pendingClient, 0 );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    const auto start = std::chrono::steady_clock::now( );
+    endpoint.Stop( );
+    EXPECT_LT( std::chrono::steady_clock::now( ) - start, std::chrono::milliseconds( 500 ) );
+    close( pendingClient );
+}
+#endif
@@ -0,0 +1,205 @@
+#include "DrawUtils.hpp"
+#include "FrameStreamer.hpp"
+#include "PoseEstimator.hpp"
+#include "SyntheticData.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// * Latency budgets for the hot paths, built as the separate yolo_pose_cpp_perf_tests target (BUILD_PERF_TESTS) and
+// * labelled 'perf' since wall-clock measurements are not reliable on shared runners. Budgets are deliberately loose
+// * so that they only trip on real regressions on a plain CPU-only machine; they can be scaled with the environment
+// * variable YOLO_POSE_PERF_BUDGET_SCALE (e.g. '4' on slow machines). Allocation budgets live in test_allocations.cpp.
+
+namespace {
+
+double BudgetScale( )
+{
+    const char* scale = std::getenv( "YOLO_POSE_PERF_BUDGET_SCALE" );
+    if ( scale == nullptr )
+        return 1.;
+    const double value = std::atof( scale );
+    return value > 0. ? value : 1.;
+}
+
+struct LatencyStatistics {
+    double medianUs;
+    double p95Us;
+};
+
+LatencyStatistics MeasureLatency( int warmupIterations, int iterations, const std::function<void( )>& f )
+{
+    for ( int i = 0; i < warmupIterations; ++i )
+        f( );
+
+    std::vector<double> samples( iterations );
+    for ( int i = 0; i < iterations; ++i ) {
+        const auto start = std::chrono::steady_clock::now( );
+        f( );
+        const auto end = std::chrono::steady_clock::now( );
+        samples[ i ] = std::chrono::duration<double, std::micro>( end - start ).count( );
+    }
+    std::sort( samples.begin( ), samples.end( ) );
+    return { .medianUs = samples[ iterations / 2 ], .p95Us = samples[ ( iterations * 95 ) / 100 ] };
+}
+
+void Report( const std::string& name, const LatencyStatistics& stats )
+{
+    std::cout << "[ BENCHMARK ] " << name << ": median " << stats.medianUs << " us, p95 " << stats.p95Us << " us\n";
+    ::testing::Test::RecordProperty( name + "_median_us", std::to_string( stats.medianUs ) );
+    ::testing::Test::RecordProperty( name + "_p95_us", std::to_string( stats.p95Us ) );
+}
+
+} // namespace
+
+class PerformanceTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        sBatchModelFilePath = sDirectory->Path( ) / "synthetic-pose-batch.onnx";
+        sVideoFilePath = sDirectory->Path( ) / "synthetic.avi";
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, SyntheticData::MakeDetections( ) ) );
+        ASSERT_TRUE( SyntheticData::WriteModel(
+            sBatchModelFilePath, SyntheticData::MakeDetections( ), SyntheticData::modelInputSize, true
+        ) );
+        ASSERT_TRUE( SyntheticData::WriteVideo( sVideoFilePath, { 640, 480 }, 10, 30. ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+    static inline std::filesystem::path sBatchModelFilePath;
+    static inline std::filesystem::path sVideoFilePath;
+};
+
+TEST_F( PerformanceTest, ForwardLatencyBudget )
+{
+    constexpr double medianBudgetUs = 5000.;
+    constexpr double p95BudgetUs = 20000.;
+
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( sModelFilePath.c_str( ), PoseEstimator::RuntimeBackend::Cpu ) );
+
+    const int size = SyntheticData::modelInputSize;
+    std::vector<float> input( 3 * size * size, 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    const auto stats =
+        MeasureLatency( 10, 200, [ & ]( ) { model.Forward( detections, input.data( ), size, size, 3 ); } );
+    Report( "Forward", stats );
+
+    EXPECT_LE( stats.medianUs, medianBudgetUs * BudgetScale( ) );
+    EXPECT_LE( stats.p95Us, p95BudgetUs * BudgetScale( ) );
+}
+
+TEST_F( PerformanceTest, ForwardLatencyPerBackend )
+{
+    // * Comparison only, the budget above applies to the default backend
+    const std::vector<std::pair<std::string, PoseEstimator::RuntimeBackend>> backends{
+        { "Forward_onnxruntime_cpu", PoseEstimator::RuntimeBackend::Cpu },
+        { "Forward_opencv_dnn_cpu", PoseEstimator::RuntimeBackend::OpenCvDnn },
+        { "Forward_opencv_dnn_cpu_fp16", PoseEstimator::RuntimeBackend::OpenCvDnnFp16 } };
+
+    const int size = SyntheticData::modelInputSize;
+    std::vector<float> input( 3 * size * size, 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    for ( const auto& [ name, backend ] : backends ) {
+        PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+        if ( !model.Initialize( sModelFilePath, backend ) ) {
+            std::cout << "[ BENCHMARK ] " << name << ": unavailable\n";
+            continue;
+        }
+        Report( name, MeasureLatency( 10, 200, [ & ]( ) {
+                    model.Forward( detections, input.data( ), size, size, 3 );
+                } ) );
+    }
+}
+
+TEST_F( PerformanceTest, ForwardBatchThroughputPerBackend )
+{
+    // * Comparison only, per frame time of a batch of 8 on a model with a dynamic batch dimension
+    constexpr int batchSize = 8;
+    const std::vector<std::pair<std::string, PoseEstimator::RuntimeBackend>> backends{
+        { "ForwardBatch_onnxruntime_cpu", PoseEstimator::RuntimeBackend::Cpu },
+        { "ForwardBatch_opencv_dnn_cpu", PoseEstimator::RuntimeBackend::OpenCvDnn },
+        { "ForwardBatch_opencv_dnn_cpu_fp16", PoseEstimator::RuntimeBackend::OpenCvDnnFp16 } };
+
+    for ( const auto& [ name, backend ] : backends ) {
+        PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+        if ( !model.Initialize( sBatchModelFilePath, backend ) ) {
+            std::cout << "[ BENCHMARK ] " << name << ": unavailable\n";
+            continue;
+        }
+        model.Benchmark( 5, batchSize );
+        const float perFrameMs = model.Benchmark( 50, batchSize );
+        std::cout << "[ BENCHMARK ] " << name << ": " << perFrameMs * 1000.f << " us per frame\n";
+        RecordProperty( name + "_per_frame_us", std::to_string( perFrameMs * 1000.f ) );
+    }
+}
+
+TEST_F( PerformanceTest, DrawPosesInFrameLatencyBudget )
+{
+    constexpr double medianBudgetUs = 5000.;
+    constexpr double p95BudgetUs = 15000.;
+
+    const auto detections = SyntheticData::MakeDetections( 10, 640 );
+    const DrawUtils::ScaleFactor scaleFactor{ .wFactor = 3.f, .hFactor = 1.6875f };
+    const auto stats = MeasureLatency( 5, 100, [ & ]( ) {
+        const cv::Mat frame = DrawUtils::DrawPosesInFrame( { 1920, 1080 }, CV_8UC3, detections, scaleFactor );
+    } );
+    Report( "DrawPosesInFrame_1080p", stats );
+
+    EXPECT_LE( stats.medianUs, medianBudgetUs * BudgetScale( ) );
+    EXPECT_LE( stats.p95Us, p95BudgetUs * BudgetScale( ) );
+}
+
+TEST_F( PerformanceTest, VideoDecodeLatencyBudget )
+{
+    constexpr double medianBudgetUs = 10000.;
+    constexpr double p95BudgetUs = 30000.;
+
+    VideoStreamer streamer( sVideoFilePath.string( ) );
+    ASSERT_TRUE( streamer.Initialize( ) );
+
+    cv::Mat frame;
+    const auto stats = MeasureLatency( 2, 50, [ & ]( ) { streamer.AcquireNextFrame( frame ); } );
+    Report( "VideoStreamer_AcquireNextFrame_480p", stats );
+
+    EXPECT_LE( stats.medianUs, medianBudgetUs * BudgetScale( ) );
+    EXPECT_LE( stats.p95Us, p95BudgetUs * BudgetScale( ) );
+}
+
+TEST_F( PerformanceTest, ImageSequenceDecodeLatencyBudget )
+{
+    constexpr double medianBudgetUs = 10000.;
+    constexpr double p95BudgetUs = 30000.;
+    constexpr int numberOfImages = 32;
+
+    SyntheticData::TemporaryDirectory directory;
+    for ( int i = 0; i < numberOfImages; ++i ) {
+        const auto imagePath = directory.Path( ) / ( "image_" + std::to_string( 1000 + i ) + ".jpg" );
+        ASSERT_TRUE( SyntheticData::WriteImage( imagePath, { 640, 480 }, SyntheticData::FrameLevel( i ) ) );
+    }
+
+    ImageSequenceStreamer streamer(
+        directory.Path( ).string( ), std::make_unique<Logger::CoutLogger>( Logger::Priority::Error )
+    );
+    ASSERT_TRUE( streamer.Initialize( ) );
+
+    cv::Mat frame;
+    const auto stats = MeasureLatency( 4, 3 * numberOfImages, [ & ]( ) { streamer.AcquireNextFrame( frame ); } );
+    Report( "ImageSequenceStreamer_AcquireNextFrame_480p", stats );
+
+    EXPECT_LE( stats.medianUs, medianBudgetUs * BudgetScale( ) );
+    EXPECT_LE( stats.p95Us, p95BudgetUs * BudgetScale( ) );
+}
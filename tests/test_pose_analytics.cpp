@@ -0,0 +1,185 @@
+#include "PoseAnalytics.hpp"
+#include "PoseFrameProcessor.hpp"
+#include "SyntheticData.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numbers>
+
+#include <gtest/gtest.h>
+
+using namespace PoseAnalytics;
+
+namespace {
+
+// * Right angle at the left elbow: shoulder ( 0, 0 ), elbow ( 3, 0 ), wrist ( 3, 4 )
+PoseEstimator::Detection MakeArm( float offsetX = 0.f )
+{
+    PoseEstimator::Detection detection{ };
+    detection.box = { .tlX = offsetX, .tlY = 0.f, .brX = offsetX + 10.f, .brY = 10.f, .score = 0.9f, .label = 0.f };
+    for ( auto& keyPoint : detection.keyPoints )
+        keyPoint = { .x = offsetX, .y = 0.f, .score = 0.9f };
+    detection.keyPoints[ PoseEstimator::leftElbow ] = { .x = offsetX + 3.f, .y = 0.f, .score = 0.9f };
+    detection.keyPoints[ PoseEstimator::leftWrist ] = { .x = offsetX + 3.f, .y = 4.f, .score = 0.9f };
+    return detection;
+}
+
+// * NaN aware comparison
+bool BitwiseEqual( const std::vector<float>& a, const std::vector<float>& b )
+{
+    return a.size( ) == b.size( ) && std::memcmp( a.data( ), b.data( ), a.size( ) * sizeof( float ) ) == 0;
+}
+
+constexpr size_t FindBone( PoseEstimator::Joint from, PoseEstimator::Joint to )
+{
+    for ( size_t i = 0; i < PoseEstimator::skeleton.size( ); ++i ) {
+        if ( PoseEstimator::skeleton[ i ].first == from && PoseEstimator::skeleton[ i ].second == to )
+            return i;
+    }
+    return PoseEstimator::skeleton.size( );
+}
+
+constexpr size_t FindAngle( PoseEstimator::Joint center )
+{
+    for ( size_t i = 0; i < jointAngles.size( ); ++i ) {
+        if ( jointAngles[ i ].center == center )
+            return i;
+    }
+    return jointAngles.size( );
+}
+
+} // namespace
+
+TEST( PoseAnalyticsTest, JointAnglesAreDerivedFromSkeleton )
+{
+    static_assert( numberOfJointAngles == 31 );
+    for ( const auto& angle : jointAngles ) {
+        EXPECT_NE( angle.from, angle.to );
+        EXPECT_NE( angle.center, angle.from );
+        EXPECT_NE( angle.center, angle.to );
+    }
+    constexpr JointAngle elbow = jointAngles[ FindAngle( PoseEstimator::leftElbow ) ];
+    EXPECT_EQ( elbow.from, PoseEstimator::leftShoulder );
+    EXPECT_EQ( elbow.to, PoseEstimator::leftWrist );
+}
+
+TEST( PoseAnalyticsTest, ComputesBoneLengthsAndAngles )
+{
+    const std::vector<std::vector<PoseEstimator::Detection>> frames{ { MakeArm( ) } };
+    const auto result = AnalyzeRecording( frames );
+
+    ASSERT_EQ( result.NumberOfFrames( ), 1u );
+    ASSERT_EQ( result.NumberOfPersons( ), 1u );
+    const size_t forearm = FindBone( PoseEstimator::leftElbow, PoseEstimator::leftWrist );
+    const size_t upperArm = FindBone( PoseEstimator::leftShoulder, PoseEstimator::leftElbow );
+    EXPECT_FLOAT_EQ( result.boneLengths[ forearm ][ 0 ], 4.f );
+    EXPECT_FLOAT_EQ( result.boneLengths[ upperArm ][ 0 ], 3.f );
+    EXPECT_NEAR( result.jointAngles[ FindAngle( PoseEstimator::leftElbow ) ][ 0 ], std::numbers::pi / 2., 1e-5 );
+    EXPECT_TRUE( std::isnan( result.motionEnergy[ 0 ] ) ); // * No previous frame
+}
+
+TEST( PoseAnalyticsTest, JointAnglesMatchAtan2InAllQuadrants )
+{
+    // * The elbow angle for wrists placed around the elbow, the shoulder lies along the negative x axis
+    const size_t elbow = FindAngle( PoseEstimator::leftElbow );
+    for ( int step = 0; step < 360; step += 5 ) {
+        const double direction = step * std::numbers::pi / 180.;
+        auto detection = MakeArm( );
+        detection.keyPoints[ PoseEstimator::leftWrist ] = {
+            .x = 3.f + 4.f * static_cast<float>( std::cos( direction ) ),
+            .y = 4.f * static_cast<float>( std::sin( direction ) ),
+            .score = 0.9f };
+        const std::vector<std::vector<PoseEstimator::Detection>> frames{ { detection } };
+        const auto result = AnalyzeRecording( frames );
+
+        const double expected = std::abs( std::remainder( std::numbers::pi - direction, 2. * std::numbers::pi ) );
+        EXPECT_NEAR( result.jointAngles[ elbow ][ 0 ], expected, 1e-5 ) << step << " degrees";
+    }
+}
+
+TEST( PoseAnalyticsTest, LowConfidenceKeyPointsYieldNaN )
+{
+    auto detection = MakeArm( );
+    detection.keyPoints[ PoseEstimator::leftWrist ].score = 0.1f;
+    const std::vector<std::vector<PoseEstimator::Detection>> frames{ { detection } };
+    const auto result = AnalyzeRecording( frames );
+
+    const size_t forearm = FindBone( PoseEstimator::leftElbow, PoseEstimator::leftWrist );
+    EXPECT_TRUE( std::isnan( result.boneLengths[ forearm ][ 0 ] ) );
+    EXPECT_TRUE( std::isnan( result.jointAngles[ FindAngle( PoseEstimator::leftElbow ) ][ 0 ] ) );
+}
+
+TEST( PoseAnalyticsTest, MotionEnergyTracksPersonsAcrossFrames )
+{
+    // * Person 0 moves one pixel to the right, person 1 disappears and a new, non overlapping person appears
+    const std::vector<std::vector<PoseEstimator::Detection>> frames{
+        { MakeArm( 0.f ), MakeArm( 100.f ) }, { MakeArm( 1.f ), MakeArm( 200.f ) } };
+    const auto result = AnalyzeRecording( frames );
+
+    ASSERT_EQ( result.frameOffsets, ( std::vector<size_t>{ 0, 2, 4 } ) );
+    EXPECT_FLOAT_EQ( result.motionEnergy[ 2 ], static_cast<float>( numberOfJoints ) );
+    EXPECT_TRUE( std::isnan( result.motionEnergy[ 3 ] ) );
+}
+
+TEST( PoseAnalyticsTest, ParallelAnalysisMatchesSerial )
+{
+    const auto detections = SyntheticData::MakeDetections( );
+    std::vector<std::vector<PoseEstimator::Detection>> frames( 5000, detections );
+    for ( size_t f = 0; f < frames.size( ); ++f ) {
+        for ( auto& detection : frames[ f ] )
+            detection.keyPoints[ f % numberOfJoints ].x += static_cast<float>( f % 7 );
+    }
+
+    const auto serial = AnalyzeRecording( frames, { .numberOfThreads = 1 } );
+    const auto parallel = AnalyzeRecording( frames, { .numberOfThreads = 4 } );
+
+    ASSERT_EQ( serial.frameOffsets, parallel.frameOffsets );
+    for ( size_t i = 0; i < numberOfBones; ++i )
+        EXPECT_TRUE( BitwiseEqual( serial.boneLengths[ i ], parallel.boneLengths[ i ] ) );
+    for ( size_t i = 0; i < numberOfJointAngles; ++i )
+        EXPECT_TRUE( BitwiseEqual( serial.jointAngles[ i ], parallel.jointAngles[ i ] ) );
+    EXPECT_TRUE( BitwiseEqual( serial.motionEnergy, parallel.motionEnergy ) );
+}
+
+TEST( PoseAnalyticsTest, FrameAnalyzerMatchesRecordingAnalysis )
+{
+    const std::vector<std::vector<PoseEstimator::Detection>> frames{
+        { MakeArm( 0.f ) }, { MakeArm( 2.f ) }, { MakeArm( 3.f ) } };
+    const auto recording = AnalyzeRecording( frames );
+
+    FrameAnalyzer analyzer;
+    for ( size_t f = 0; f < frames.size( ); ++f ) {
+        const auto& result = analyzer.Analyze( frames[ f ] );
+        ASSERT_EQ( result.NumberOfPersons( ), 1u );
+        if ( f == 0 )
+            EXPECT_TRUE( std::isnan( result.motionEnergy[ 0 ] ) );
+        else
+            EXPECT_FLOAT_EQ( result.motionEnergy[ 0 ], recording.motionEnergy[ f ] );
+    }
+}
+
+TEST( PoseAnalyticsTest, PoseFrameProcessorFillsMotionEnergy )
+{
+    const SyntheticData::TemporaryDirectory directory;
+    const auto modelFilePath = directory.Path( ) / "synthetic-pose.onnx";
+    const auto detections = SyntheticData::MakeDetections( );
+    ASSERT_TRUE( SyntheticData::WriteModel( modelFilePath, detections ) );
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( modelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+
+    FrameAnalyzer analyzer;
+    PoseFrameProcessor processor( model, nullptr, &analyzer );
+    const cv::Mat frame( 480, 640, CV_8UC3, cv::Scalar::all( 0 ) );
+    PoseResult result;
+
+    // * The synthetic model returns the same persons for every frame, so only the first frame has no motion
+    processor( frame, result );
+    ASSERT_EQ( result.motionEnergy.size( ), detections.size( ) );
+    EXPECT_TRUE( std::isnan( result.motionEnergy[ 0 ] ) );
+
+    processor( frame, result );
+    ASSERT_EQ( result.motionEnergy.size( ), detections.size( ) );
+    for ( const float energy : result.motionEnergy )
+        EXPECT_FLOAT_EQ( energy, 0.f );
+}
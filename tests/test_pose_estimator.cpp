@@ -0,0 +1,152 @@
+#include "PoseEstimator.hpp"
+#include "PoseFrameProcessor.hpp"
+#include "SyntheticData.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::unique_ptr<Logger::ILogger> MakeLogger( )
+{
+    return std::make_unique<Logger::CoutLogger>( Logger::Priority::Error );
+}
+
+void ExpectDetectionsNear(
+    const std::vector<PoseEstimator::Detection>& actual,
+    const std::vector<PoseEstimator::Detection>& expected,
+    float offset,
+    float tolerance = 1e-5f
+)
+{
+    ASSERT_EQ( actual.size( ), expected.size( ) );
+    for ( size_t i = 0; i < actual.size( ); ++i ) {
+        EXPECT_NEAR( actual[ i ].box.tlX, expected[ i ].box.tlX + offset, tolerance );
+        EXPECT_NEAR( actual[ i ].box.tlY, expected[ i ].box.tlY + offset, tolerance );
+        EXPECT_NEAR( actual[ i ].box.brX, expected[ i ].box.brX + offset, tolerance );
+        EXPECT_NEAR( actual[ i ].box.brY, expected[ i ].box.brY + offset, tolerance );
+        EXPECT_NEAR( actual[ i ].box.score, expected[ i ].box.score + offset, tolerance );
+        EXPECT_NEAR( actual[ i ].box.label, expected[ i ].box.label + offset, tolerance );
+        for ( size_t k = 0; k < actual[ i ].keyPoints.size( ); ++k ) {
+            EXPECT_NEAR( actual[ i ].keyPoints[ k ].x, expected[ i ].keyPoints[ k ].x + offset, tolerance );
+            EXPECT_NEAR( actual[ i ].keyPoints[ k ].y, expected[ i ].keyPoints[ k ].y + offset, tolerance );
+            EXPECT_NEAR( actual[ i ].keyPoints[ k ].score, expected[ i ].keyPoints[ k ].score + offset, tolerance );
+        }
+    }
+}
+
+} // namespace
+
+class PoseEstimatorTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, SyntheticData::MakeDetections( ) ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    void SetUp( ) override
+    {
+        mModel = std::make_unique<PoseEstimator>( MakeLogger( ) );
+        ASSERT_TRUE( mModel->Initialize( sModelFilePath.c_str( ), PoseEstimator::RuntimeBackend::Cpu, "test" ) );
+    }
+
+    static std::vector<float> MakeInput( float value )
+    {
+        const int size = SyntheticData::modelInputSize;
+        return std::vector<float>( 3 * size * size, value );
+    }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+    std::unique_ptr<PoseEstimator> mModel;
+};
+
+TEST_F( PoseEstimatorTest, ReportsModelInputSize )
+{
+    const auto inputSize = mModel->GetModelInputSize( );
+    EXPECT_EQ( inputSize.width, SyntheticData::modelInputSize );
+    EXPECT_EQ( inputSize.height, SyntheticData::modelInputSize );
+    EXPECT_EQ( inputSize.channels, 3 );
+}
+
+TEST_F( PoseEstimatorTest, ForwardOnZeroInputReturnsAnchors )
+{
+    auto input = MakeInput( 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    const int size = SyntheticData::modelInputSize;
+    ASSERT_TRUE( mModel->Forward( detections, input.data( ), size, size, 3 ) );
+    ExpectDetectionsNear( detections, SyntheticData::MakeDetections( ), 0.f );
+}
+
+TEST_F( PoseEstimatorTest, ForwardOutputDependsOnInput )
+{
+    auto input = MakeInput( 0.25f );
+    std::vector<PoseEstimator::Detection> detections;
+    const int size = SyntheticData::modelInputSize;
+    ASSERT_TRUE( mModel->Forward( detections, input.data( ), size, size, 3 ) );
+    ExpectDetectionsNear( detections, SyntheticData::MakeDetections( ), 0.25f );
+}
+
+TEST_F( PoseEstimatorTest, ForwardReusesDetectionStorage )
+{
+    auto input = MakeInput( 0.f );
+    std::vector<PoseEstimator::Detection> detections( 1 );
+    const int size = SyntheticData::modelInputSize;
+    ASSERT_TRUE( mModel->Forward( detections, input.data( ), size, size, 3 ) );
+    ASSERT_TRUE( mModel->Forward( detections, input.data( ), size, size, 3 ) );
+    EXPECT_EQ( detections.size( ), static_cast<size_t>( SyntheticData::numberOfDetections ) );
+}
+
+TEST_F( PoseEstimatorTest, ForwardRejectsInvalidInput )
+{
+    auto input = MakeInput( 0.f );
+    std::vector<PoseEstimator::Detection> detections;
+    const int size = SyntheticData::modelInputSize;
+    EXPECT_FALSE( mModel->Forward( detections, nullptr, size, size, 3 ) );
+    EXPECT_FALSE( mModel->Forward( detections, input.data( ), size + 1, size, 3 ) );
+    EXPECT_FALSE( mModel->Forward( detections, input.data( ), size, size - 1, 3 ) );
+    EXPECT_FALSE( mModel->Forward( detections, input.data( ), size, size, 1 ) );
+}
+
+TEST_F( PoseEstimatorTest, BenchmarkReturnsNonNegativeLatency )
+{
+    EXPECT_GE( mModel->Benchmark( 3 ), 0.f );
+}
+
+TEST_F( PoseEstimatorTest, PoseFrameProcessorScalesToFrame )
+{
+    PoseFrameProcessor processor( *mModel );
+    const int size = SyntheticData::modelInputSize;
+    const cv::Mat frame( size * 3 / 2, size * 2, CV_8UC3, cv::Scalar::all( 0 ) );
+
+    PoseResult result;
+    result.detections.resize( 1 );
+    processor( frame, result );
+    ExpectDetectionsNear( result.detections, SyntheticData::MakeDetections( ), 0.f );
+    EXPECT_FLOAT_EQ( result.scaleFactor.wFactor, 2.f );
+    EXPECT_FLOAT_EQ( result.scaleFactor.hFactor, 1.5f );
+    EXPECT_EQ( result.Overlay( frame.size( ), frame.type( ) ).size( ), frame.size( ) );
+}
+
+TEST( PoseEstimatorInitializationTest, ForwardOnUninitializedModelFails )
+{
+    PoseEstimator model( MakeLogger( ) );
+    std::vector<float> input( 3 * 640 * 640 );
+    std::vector<PoseEstimator::Detection> detections;
+    EXPECT_FALSE( model.Forward( detections, input.data( ), 640, 640, 3 ) );
+    EXPECT_LT( model.Benchmark( 1 ), 0.f );
+}
+
+TEST( PoseEstimatorInitializationTest, InitializeWithMissingModelFails )
+{
+    SyntheticData::TemporaryDirectory directory;
+    const auto missing = directory.Path( ) / "missing.onnx";
+    PoseEstimator model( MakeLogger( ) );
+    EXPECT_FALSE( model.Initialize( missing.c_str( ), PoseEstimator::RuntimeBackend::Cpu ) );
+}
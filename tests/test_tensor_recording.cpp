@@ -0,0 +1,147 @@
+#include "SyntheticData.hpp"
+#include "TensorRecording.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class TensorRecordingTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, SyntheticData::MakeDetections( ) ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    void SetUp( ) override
+    {
+        mModel = std::make_unique<PoseEstimator>( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+        ASSERT_TRUE( mModel->Initialize( sModelFilePath.c_str( ), PoseEstimator::RuntimeBackend::Cpu ) );
+        mRecordingFilePath = sDirectory->Path( ) / "recording.yptr";
+    }
+
+    // * Records 'numberOfFrames' live inferences on constant inputs 0, 0.1, 0.2, ...
+    void RecordRun( int numberOfFrames, bool corruptLastFrame = false )
+    {
+        TensorRecording::Recorder recorder( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+        ASSERT_TRUE( recorder.Open( mRecordingFilePath, mModel->GetModelInputSize( ) ) );
+
+        const int size = SyntheticData::modelInputSize;
+        std::vector<PoseEstimator::Detection> detections;
+        for ( int i = 0; i < numberOfFrames; ++i ) {
+            std::vector<float> input( 3 * size * size, 0.1f * i );
+            ASSERT_TRUE( mModel->Forward( detections, input.data( ), size, size, 3 ) );
+            if ( corruptLastFrame && i == numberOfFrames - 1 )
+                detections[ 0 ].box.tlX += 1.f;
+            ASSERT_TRUE( recorder.Record( input.data( ), detections ) );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+        }
+        EXPECT_EQ( recorder.NumberOfRecords( ), static_cast<size_t>( numberOfFrames ) );
+        recorder.Close( );
+    }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+    std::unique_ptr<PoseEstimator> mModel;
+    std::filesystem::path mRecordingFilePath;
+};
+
+TEST_F( TensorRecordingTest, ReaderRestoresRecordedTensorsAndDetections )
+{
+    RecordRun( 4 );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    ASSERT_EQ( reader.NumberOfRecords( ), 4u );
+    EXPECT_EQ( reader.GetInputSize( ).width, SyntheticData::modelInputSize );
+    EXPECT_EQ( reader.GetInputSize( ).channels, 3 );
+
+    std::chrono::nanoseconds previousTimestamp{ -1 };
+    for ( size_t i = 0; i < reader.NumberOfRecords( ); ++i ) {
+        const auto record = reader.GetRecord( i );
+        EXPECT_FLOAT_EQ( record.tensor[ 0 ], 0.1f * i );
+        EXPECT_EQ( record.detections.size( ), static_cast<size_t>( SyntheticData::numberOfDetections ) );
+        EXPECT_GT( record.timestamp, previousTimestamp );
+        previousTimestamp = record.timestamp;
+    }
+}
+
+TEST_F( TensorRecordingTest, ReplayIsBitExactOnSameModel )
+{
+    RecordRun( 5 );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    TensorRecording::ReplayReport report;
+    ASSERT_TRUE( TensorRecording::Replay( *mModel, reader, { .tolerance = 0.f, .iterations = 3 }, report ) );
+    EXPECT_EQ( report.frames, 15u );
+    EXPECT_TRUE( report.Matches( ) );
+    EXPECT_EQ( report.maxAbsoluteError, 0.f );
+    EXPECT_GT( report.medianForwardMs, 0. );
+}
+
+TEST_F( TensorRecordingTest, ReplayReportsMismatches )
+{
+    RecordRun( 3, true );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    TensorRecording::ReplayReport report;
+    ASSERT_TRUE( TensorRecording::Replay( *mModel, reader, { .tolerance = 0.5f }, report ) );
+    EXPECT_FALSE( report.Matches( ) );
+    EXPECT_EQ( report.mismatchedFrames, 1u );
+    EXPECT_EQ( report.firstMismatchedRecord, 2u );
+    EXPECT_NEAR( report.maxAbsoluteError, 1.f, 1e-5f );
+}
+
+TEST_F( TensorRecordingTest, ReplayReportsInputShapeMismatch )
+{
+    RecordRun( 2 );
+
+    const auto smallModelFilePath = sDirectory->Path( ) / "synthetic-pose-32.onnx";
+    ASSERT_TRUE( SyntheticData::WriteModel( smallModelFilePath, SyntheticData::MakeDetections( ), 32 ) );
+    PoseEstimator smallModel( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( smallModel.Initialize( smallModelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    TensorRecording::ReplayReport report;
+    EXPECT_FALSE( TensorRecording::Replay( smallModel, reader, { }, report ) );
+    EXPECT_EQ( report.failure, TensorRecording::ReplayReport::Failure::InputShapeMismatch );
+    EXPECT_EQ( report.frames, 0u );
+}
+
+TEST_F( TensorRecordingTest, ReplayWithOriginalTimingFollowsTimestamps )
+{
+    RecordRun( 3 );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    TensorRecording::ReplayReport report;
+    const TensorRecording::ReplayOptions options{ .timing = TensorRecording::ReplayOptions::Timing::Original };
+    ASSERT_TRUE( TensorRecording::Replay( *mModel, reader, options, report ) );
+    EXPECT_TRUE( report.Matches( ) );
+    EXPECT_GE( report.totalSeconds, std::chrono::duration<double>( reader.GetRecord( 2 ).timestamp ).count( ) );
+}
+
+TEST_F( TensorRecordingTest, ReaderSkipsTruncatedTrailingRecord )
+{
+    RecordRun( 3 );
+    std::filesystem::resize_file( mRecordingFilePath, std::filesystem::file_size( mRecordingFilePath ) - 10 );
+
+    TensorRecording::Reader reader;
+    ASSERT_TRUE( reader.Open( mRecordingFilePath ) );
+    EXPECT_EQ( reader.NumberOfRecords( ), 2u );
+}
+
+TEST_F( TensorRecordingTest, ReaderRejectsInvalidFiles )
+{
+    TensorRecording::Reader reader;
+    EXPECT_FALSE( reader.Open( sDirectory->Path( ) / "missing.yptr" ) );
+    EXPECT_FALSE( reader.Open( sModelFilePath ) );
+}
@@ -0,0 +1,224 @@
+#include "SyntheticData.hpp"
+#include "TiledInference.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TiledInference::RegionDetection MakeBox(
+    float tlX, float tlY, float size, float score, int region = 0, bool atSeam = false
+)
+{
+    PoseEstimator::Detection detection{ };
+    detection.box = { .tlX = tlX, .tlY = tlY, .brX = tlX + size, .brY = tlY + size, .score = score, .label = 0.f };
+    return { .detection = detection, .region = region, .atSeam = atSeam };
+}
+
+} // namespace
+
+TEST( TiledInferenceTest, TilesCoverFrameWithOverlap )
+{
+    const auto tiles = TiledInference::MakeTiles( { 1000, 600 }, 640, 128 );
+    ASSERT_EQ( tiles.size( ), 2u );
+    EXPECT_EQ( tiles[ 0 ].x, 0 );
+    EXPECT_EQ( tiles[ 1 ].x, 360 );
+    for ( const auto& tile : tiles ) {
+        EXPECT_EQ( tile.y, 0 );
+        EXPECT_EQ( tile.height, 600 ); // * Clamped to the frame
+        EXPECT_EQ( tile.width, 640 );
+    }
+
+    EXPECT_EQ( TiledInference::MakeTiles( { 3840, 2160 }, 640, 128 ).size( ), 8u * 4u );
+    EXPECT_EQ( TiledInference::MakeTiles( { 320, 240 }, 640, 128 ).size( ), 1u );
+}
+
+TEST( TiledInferenceTest, RejectsOverlapNotSmallerThanTile )
+{
+    EXPECT_TRUE( TiledInference::MakeTiles( { 1000, 600 }, 640, 640 ).empty( ) );
+    EXPECT_TRUE( TiledInference::MakeTiles( { 1000, 600 }, 640, 700 ).empty( ) );
+    EXPECT_TRUE( TiledInference::MakeTiles( { 1000, 600 }, 640, -1 ).empty( ) );
+}
+
+TEST( TiledInferenceTest, NonMaximumSuppressionKeepsBestOfOverlappingDetections )
+{
+    std::vector<TiledInference::RegionDetection> detections{
+        MakeBox( 0.f, 0.f, 10.f, 0.6f ), MakeBox( 1.f, 0.f, 10.f, 0.9f, 1 ), MakeBox( 50.f, 50.f, 10.f, 0.7f ) };
+    TiledInference::NonMaximumSuppression( detections, 0.5f, 0.8f );
+
+    ASSERT_EQ( detections.size( ), 2u );
+    EXPECT_FLOAT_EQ( detections[ 0 ].detection.box.score, 0.9f );
+    EXPECT_FLOAT_EQ( detections[ 1 ].detection.box.score, 0.7f );
+}
+
+TEST( TiledInferenceTest, NonMaximumSuppressionMergesCutOffDetections )
+{
+    // * The right half of a person cut off at the left seam of tile 1 has an IoU of exactly 0.5 with the full box
+    auto cutOff = MakeBox( 10.f, 0.f, 20.f, 0.6f, 1, true );
+    cutOff.detection.box.brX = 20.f;
+    std::vector<TiledInference::RegionDetection> detections{ MakeBox( 0.f, 0.f, 20.f, 0.9f ), cutOff };
+
+    auto iouOnly = detections;
+    TiledInference::NonMaximumSuppression( iouOnly, 0.5f, 1.f );
+    EXPECT_EQ( iouOnly.size( ), 2u );
+
+    TiledInference::NonMaximumSuppression( detections, 0.5f, 0.8f );
+    ASSERT_EQ( detections.size( ), 1u );
+    EXPECT_FLOAT_EQ( detections[ 0 ].detection.box.brX, 20.f );
+    EXPECT_FLOAT_EQ( detections[ 0 ].detection.box.score, 0.9f );
+
+    // * On equal scores the full box is kept
+    std::vector<TiledInference::RegionDetection> tied{ cutOff, MakeBox( 0.f, 0.f, 20.f, 0.6f ) };
+    TiledInference::NonMaximumSuppression( tied, 0.5f, 0.8f );
+    ASSERT_EQ( tied.size( ), 1u );
+    EXPECT_FLOAT_EQ( tied[ 0 ].detection.box.tlX, 0.f );
+}
+
+TEST( TiledInferenceTest, NonMaximumSuppressionKeepsNestedPersons )
+{
+    // * A child standing in front of an adult, entirely inside the adult's box
+    const auto adult = MakeBox( 0.f, 0.f, 40.f, 0.9f );
+    const auto child = MakeBox( 10.f, 20.f, 15.f, 0.8f );
+
+    std::vector<TiledInference::RegionDetection> sameRegion{ adult, child };
+    TiledInference::NonMaximumSuppression( sameRegion, 0.5f, 0.8f );
+    EXPECT_EQ( sameRegion.size( ), 2u );
+
+    // * From another region the child is only merged if it touches a seam there
+    auto otherRegion = child;
+    otherRegion.region = 1;
+    std::vector<TiledInference::RegionDetection> detections{ adult, otherRegion };
+    TiledInference::NonMaximumSuppression( detections, 0.5f, 0.8f );
+    EXPECT_EQ( detections.size( ), 2u );
+
+    otherRegion.atSeam = true;
+    detections = { adult, otherRegion };
+    TiledInference::NonMaximumSuppression( detections, 0.5f, 0.8f );
+    EXPECT_EQ( detections.size( ), 1u );
+}
+
+class TiledInferenceModelTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite( )
+    {
+        sDirectory = std::make_unique<SyntheticData::TemporaryDirectory>( );
+        sModelFilePath = sDirectory->Path( ) / "synthetic-pose.onnx";
+        ASSERT_TRUE( SyntheticData::WriteModel( sModelFilePath, SyntheticData::MakeDetections( ) ) );
+    }
+
+    static void TearDownTestSuite( ) { sDirectory.reset( ); }
+
+    void SetUp( ) override
+    {
+        mModel = std::make_unique<PoseEstimator>( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+        ASSERT_TRUE( mModel->Initialize( sModelFilePath.c_str( ), PoseEstimator::RuntimeBackend::Cpu ) );
+    }
+
+    static inline std::unique_ptr<SyntheticData::TemporaryDirectory> sDirectory;
+    static inline std::filesystem::path sModelFilePath;
+    std::unique_ptr<PoseEstimator> mModel;
+};
+
+TEST_F( TiledInferenceModelTest, ForwardParallelMatchesForward )
+{
+    const int size = SyntheticData::modelInputSize;
+    std::vector<std::vector<float>> frames;
+    std::vector<float*> framesData;
+    for ( int i = 0; i < 6; ++i ) {
+        frames.emplace_back( 3 * size * size, 0.1f * i );
+        framesData.push_back( frames.back( ).data( ) );
+    }
+
+    std::vector<std::vector<PoseEstimator::Detection>> parallel;
+    ASSERT_TRUE( mModel->ForwardParallel( parallel, framesData, size, size, 3, 3 ) );
+    ASSERT_EQ( parallel.size( ), frames.size( ) );
+    for ( size_t i = 0; i < frames.size( ); ++i ) {
+        std::vector<PoseEstimator::Detection> serial;
+        ASSERT_TRUE( mModel->Forward( serial, framesData[ i ], size, size, 3 ) );
+        ASSERT_EQ( serial.size( ), parallel[ i ].size( ) );
+        EXPECT_FLOAT_EQ( serial[ 0 ].box.tlX, parallel[ i ][ 0 ].box.tlX );
+    }
+}
+
+TEST_F( TiledInferenceModelTest, TranslatesDetectionsAndMergesSeamDuplicates )
+{
+    // * Two 64 px tiles overlapping by 32 px; on a black frame every tile yields the synthetic anchors, which
+    // * are laid out on a 16 px grid so that the anchors inside the overlap coincide exactly
+    const int size = SyntheticData::modelInputSize;
+    const cv::Mat frame( size, size + size / 2, CV_8UC3, cv::Scalar::all( 0 ) );
+    const TiledInference::Options options{
+        .tileSize = size, .tileOverlap = size / 2, .coarsePass = false, .numberOfWorkers = 2 };
+
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( TiledInference::Forward( *mModel, frame, detections, options ) );
+
+    // * Tile 0 anchors: ( 0, 0 ), ( 16, 0 ), ( 32, 0 ), ( 0, 16 ); tile 1 adds ( 48, 0 ), ( 64, 0 ), ( 32, 16 )
+    ASSERT_EQ( detections.size( ), 7u );
+    float maxX = 0.f;
+    for ( const auto& detection : detections ) {
+        maxX = std::max( maxX, detection.box.tlX );
+        EXPECT_GE( detection.keyPoints[ 0 ].x, detection.box.tlX );
+        EXPECT_LE( detection.keyPoints[ 0 ].x, detection.box.brX );
+    }
+    EXPECT_FLOAT_EQ( maxX, 64.f );
+}
+
+TEST_F( TiledInferenceModelTest, RejectsOverlapNotSmallerThanTile )
+{
+    const int size = SyntheticData::modelInputSize;
+    const cv::Mat frame( size, 2 * size, CV_8UC3, cv::Scalar::all( 0 ) );
+    std::vector<PoseEstimator::Detection> detections;
+    EXPECT_FALSE( TiledInference::Forward( *mModel, frame, detections, { .tileSize = size, .tileOverlap = size } ) );
+    EXPECT_TRUE( detections.empty( ) );
+}
+
+TEST_F( TiledInferenceModelTest, CoarseDetectionsSurviveMerging )
+{
+    // * A model seeing one person filling its whole input: every tile yields a box covering the tile, i.e. a cut-off
+    // * part of the person, and the coarse pass yields the full frame box
+    const int size = SyntheticData::modelInputSize;
+    auto anchor = SyntheticData::MakeDetections( 1 );
+    const float side = static_cast<float>( size );
+    anchor[ 0 ].box = { .tlX = 0.f, .tlY = 0.f, .brX = side, .brY = side, .score = 0.9f, .label = 0.f };
+    const auto modelFilePath = sDirectory->Path( ) / "synthetic-large-person.onnx";
+    ASSERT_TRUE( SyntheticData::WriteModel( modelFilePath, anchor ) );
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( modelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+
+    const cv::Mat frame( size, 2 * size + size / 2, CV_8UC3, cv::Scalar::all( 0 ) );
+    TiledInference::Options options{ .tileSize = size, .tileOverlap = size / 4, .coarsePass = true };
+    ASSERT_EQ( TiledInference::MakeTiles( frame.size( ), options.tileSize, options.tileOverlap ).size( ), 3u );
+
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( TiledInference::Forward( model, frame, detections, options ) );
+    ASSERT_EQ( detections.size( ), 1u );
+    EXPECT_FLOAT_EQ( detections[ 0 ].box.tlX, 0.f );
+    EXPECT_FLOAT_EQ( detections[ 0 ].box.brX, static_cast<float>( frame.cols ) );
+    EXPECT_FLOAT_EQ( detections[ 0 ].box.brY, static_cast<float>( frame.rows ) );
+
+    // * Without the coarse pass only the tiles remain
+    options.coarsePass = false;
+    ASSERT_TRUE( TiledInference::Forward( model, frame, detections, options ) );
+    EXPECT_EQ( detections.size( ), 3u );
+}
+
+TEST_F( TiledInferenceModelTest, NestedPersonsFromOneRegionSurviveMerging )
+{
+    const int size = SyntheticData::modelInputSize;
+    auto anchors = SyntheticData::MakeDetections( 2 );
+    anchors[ 0 ].box = { .tlX = 0.f, .tlY = 0.f, .brX = 48.f, .brY = 60.f, .score = 0.9f, .label = 0.f };
+    anchors[ 1 ].box = { .tlX = 16.f, .tlY = 24.f, .brX = 32.f, .brY = 56.f, .score = 0.8f, .label = 0.f };
+    const auto modelFilePath = sDirectory->Path( ) / "synthetic-nested-persons.onnx";
+    ASSERT_TRUE( SyntheticData::WriteModel( modelFilePath, anchors ) );
+    PoseEstimator model( std::make_unique<Logger::CoutLogger>( Logger::Priority::Error ) );
+    ASSERT_TRUE( model.Initialize( modelFilePath, PoseEstimator::RuntimeBackend::Cpu ) );
+
+    // * Two tiles with the nested pair away from the seam of the first one
+    const cv::Mat frame( size, 2 * size, CV_8UC3, cv::Scalar::all( 0 ) );
+    const TiledInference::Options options{ .tileSize = size, .tileOverlap = 0, .coarsePass = false };
+    std::vector<PoseEstimator::Detection> detections;
+    ASSERT_TRUE( TiledInference::Forward( model, frame, detections, options ) );
+    EXPECT_EQ( detections.size( ), 4u );
+}